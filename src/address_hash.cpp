@@ -0,0 +1,106 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cassert>
+
+#include "address_hash.hpp"
+
+AddressHash::AddressHash( Configuration const & config, int slices )
+  : _slices( slices ), _bits( 0 )
+{
+  if ( slices <= 0 ) {
+    cout << "Error: Address hash needs at least one L2 slice." << endl;
+    exit(-1);
+  }
+
+  string const type = config.GetStr( "l2_hash" );
+  if ( type == "interleave" ) {
+    _type = interleave;
+  } else if ( type == "xor" ) {
+    _type = xor_fold;
+  } else if ( type == "select" ) {
+    _type = bit_select;
+    _select = config.GetIntArray( "l2_hash_bits" );
+    if ( _select.empty( ) ) {
+      cout << "Error: l2_hash = select needs l2_hash_bits." << endl;
+      exit(-1);
+    }
+    for ( size_t i = 0; i < _select.size( ); ++i ) {
+      if ( ( _select[i] < 0 ) || ( _select[i] > 63 ) ) {
+        cout << "Error: l2_hash_bits must be address bits 0 to 63." << endl;
+        exit(-1);
+      }
+    }
+  } else {
+    cout << "Error: Unknown l2_hash: " << type << endl;
+    exit(-1);
+  }
+
+  int const block = config.GetInt( "l2_interleave" );
+  if ( block <= 0 ) {
+    cout << "Error: l2_interleave must be positive." << endl;
+    exit(-1);
+  }
+  _block = block;
+
+  // width of a slice index
+  while ( ( 1 << _bits ) < _slices ) {
+    ++_bits;
+  }
+}
+
+int AddressHash::Slice( unsigned long long addr ) const
+{
+  unsigned long long block = addr / _block;
+  if ( _type == bit_select ) {
+    block = 0;
+    for ( size_t i = 0; i < _select.size( ); ++i ) {
+      block |= ( ( addr >> _select[i] ) & 1ULL ) << i;
+    }
+  } else if ( ( _type == xor_fold ) && ( _bits > 0 ) ) {
+    unsigned long long h = 0;
+    if ( ( _slices & ( _slices - 1 ) ) == 0 ) {
+      unsigned long long const mask = ( 1ULL << _bits ) - 1;
+      for ( ; block; block >>= _bits ) {
+        h ^= block & mask;
+      }
+    } else {
+      // a fold of _bits wide digits is not uniform modulo _slices, so add
+      // up the base _slices digits instead: each digit covers all slices
+      for ( ; block; block /= _slices ) {
+        h = ( h + block % _slices ) % _slices;
+      }
+    }
+    block = h;
+  }
+  int const slice = (int)( block % _slices );
+  assert( ( slice >= 0 ) && ( slice < _slices ) );
+  return slice;
+}
@@ -0,0 +1,65 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+/*address_hash.hpp
+ *
+ *Maps memory addresses to L2 slices. "interleave" spreads consecutive
+ *blocks of l2_interleave bytes round robin over the slices, "xor" folds
+ *the block number onto itself so that power-of-two strides still spread
+ *(modulo the slice count unless that is a power of two), and "select" builds the slice index from the address bits listed in
+ *l2_hash_bits, lowest index bit first
+ *
+ */
+
+#ifndef _ADDRESS_HASH_HPP_
+#define _ADDRESS_HASH_HPP_
+
+#include <string>
+#include <vector>
+
+#include "config_utils.hpp"
+
+class AddressHash {
+
+  enum HashType { interleave, xor_fold, bit_select };
+
+  HashType _type;
+  int _slices;
+  unsigned long long _block;
+  int _bits;
+  vector<int> _select;
+
+public:
+
+  AddressHash( Configuration const & config, int slices );
+
+  int Slice( unsigned long long addr ) const;
+};
+
+#endif
@@ -41,6 +41,8 @@
 #include "selalloc.hpp"
 #include "separable_input_first.hpp"
 #include "separable_output_first.hpp"
+#include "bit_separable_input_first.hpp"
+#include "bit_separable_output_first.hpp"
 //
 /////////////////////////////////////////////////////////////////////////
 
@@ -469,6 +471,10 @@ Allocator *Allocator::NewAllocator( Module *parent, const string& name,
     string arb_type = param_str.empty() ? (config ? config->GetStr("arb_type") : "round_robin") : param_str;
     a = new SeparableOutputFirstAllocator( parent, name, inputs, outputs,
 					   arb_type );
+  } else if (alloc_name == "bit_separable_input_first") {
+    a = new BitSeparableInputFirstAllocator( parent, name, inputs, outputs );
+  } else if (alloc_name == "bit_separable_output_first") {
+    a = new BitSeparableOutputFirstAllocator( parent, name, inputs, outputs );
   }
 
 //==================================================
@@ -36,6 +36,9 @@
 #include "module.hpp"
 #include "config_utils.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class Allocator : public Module {
 protected:
   const int _inputs;
@@ -81,6 +84,11 @@ public:
   virtual void PrintRequests( ostream * os = NULL ) const = 0;
   void PrintGrants( ostream * os = NULL ) const;
 
+  // state kept across cycles (e.g. priority pointers); requests and
+  // matches are rebuilt every cycle and are not part of it
+  virtual void Save( CheckpointWriter & w ) const {}
+  virtual void Load( CheckpointReader & r ) {}
+
   static Allocator *NewAllocator( Module *parent, const string& name,
 				  const string &alloc_type, 
 				  int inputs, int outputs, 
@@ -0,0 +1,332 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// ----------------------------------------------------------------------
+//
+//  BitSeparableAllocator: Bit-Parallel Separable Allocator Base Class
+//
+// ----------------------------------------------------------------------
+
+#include "bit_separable.hpp"
+
+#include <iostream>
+#include <limits>
+#include <cassert>
+
+#include "checkpoint.hpp"
+
+BitSeparableAllocator::BitSeparableAllocator( Module* parent,
+					      const string& name,
+					      int inputs, int outputs )
+  : Allocator( parent, name, inputs, outputs ),
+    _in_words( ( inputs + 63 ) / 64 ), _out_words( ( outputs + 63 ) / 64 )
+{
+  _request.resize(_inputs * _outputs);
+
+  _in_mask.resize(_inputs * _out_words, 0);
+  _in_best.resize(_inputs * _out_words, 0);
+  _in_best_pri.resize(_inputs, numeric_limits<int>::min());
+
+  _out_mask.resize(_outputs * _in_words, 0);
+  _out_best.resize(_outputs * _in_words, 0);
+  _out_best_pri.resize(_outputs, numeric_limits<int>::min());
+
+  _in_occ.resize(_in_words, 0);
+  _out_occ.resize(_out_words, 0);
+
+  _grant.resize(max(_inputs * _out_words, _outputs * _in_words), 0);
+  _grant_pri.resize(max(_inputs, _outputs), numeric_limits<int>::min());
+
+  _in_ptr.resize(_inputs, 0);
+  _out_ptr.resize(_outputs, 0);
+}
+
+bool BitSeparableAllocator::_Empty( word_t const * row, int words )
+{
+  for ( int w = 0; w < words; ++w ) {
+    if ( row[w] ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int BitSeparableAllocator::_Count( word_t const * row, int words )
+{
+  int count = 0;
+  for ( int w = 0; w < words; ++w ) {
+    count += __builtin_popcountll( row[w] );
+  }
+  return count;
+}
+
+int BitSeparableAllocator::_RoundRobin( word_t const * row, int words,
+					int ptr )
+{
+  int const start = ptr >> 6;
+  word_t const upper = row[start] & ( ~0ULL << ( ptr & 63 ) );
+  if ( upper ) {
+    return ( start << 6 ) + __builtin_ctzll( upper );
+  }
+  for ( int w = start + 1; w < words; ++w ) {
+    if ( row[w] ) {
+      return ( w << 6 ) + __builtin_ctzll( row[w] );
+    }
+  }
+  for ( int w = 0; w <= start; ++w ) {
+    if ( row[w] ) {
+      return ( w << 6 ) + __builtin_ctzll( row[w] );
+    }
+  }
+  return -1;
+}
+
+void BitSeparableAllocator::_AddBest( word_t * row, int words, int & best_pri,
+				      int i, int pri )
+{
+  if ( pri > best_pri ) {
+    for ( int w = 0; w < words; ++w ) {
+      row[w] = 0;
+    }
+    best_pri = pri;
+  }
+  if ( pri == best_pri ) {
+    _Set( row, i );
+  }
+}
+
+void BitSeparableAllocator::_RebuildInBest( int in )
+{
+  word_t const * mask = &_in_mask[in * _out_words];
+  word_t * best = &_in_best[in * _out_words];
+  for ( int w = 0; w < _out_words; ++w ) {
+    best[w] = 0;
+  }
+  _in_best_pri[in] = numeric_limits<int>::min();
+  for ( int w = 0; w < _out_words; ++w ) {
+    for ( word_t m = mask[w]; m; m &= m - 1 ) {
+      int const out = ( w << 6 ) + __builtin_ctzll( m );
+      _AddBest( best, _out_words, _in_best_pri[in], out,
+		_request[in * _outputs + out].in_pri );
+    }
+  }
+}
+
+void BitSeparableAllocator::_RebuildOutBest( int out )
+{
+  word_t const * mask = &_out_mask[out * _in_words];
+  word_t * best = &_out_best[out * _in_words];
+  for ( int w = 0; w < _in_words; ++w ) {
+    best[w] = 0;
+  }
+  _out_best_pri[out] = numeric_limits<int>::min();
+  for ( int w = 0; w < _in_words; ++w ) {
+    for ( word_t m = mask[w]; m; m &= m - 1 ) {
+      int const in = ( w << 6 ) + __builtin_ctzll( m );
+      _AddBest( best, _in_words, _out_best_pri[out], in,
+		_request[in * _outputs + out].out_pri );
+    }
+  }
+}
+
+void BitSeparableAllocator::_Match( int in, int out )
+{
+  assert( ( _inmatch[in] == -1 ) && ( _outmatch[out] == -1 ) );
+
+  _inmatch[in] = out;
+  _outmatch[out] = in;
+  _in_ptr[in] = ( out + 1 ) % _outputs;
+  _out_ptr[out] = ( in + 1 ) % _inputs;
+}
+
+void BitSeparableAllocator::Clear( )
+{
+  for ( int w = 0; w < _in_words; ++w ) {
+    for ( word_t m = _in_occ[w]; m; m &= m - 1 ) {
+      int const in = ( w << 6 ) + __builtin_ctzll( m );
+      for ( int v = 0; v < _out_words; ++v ) {
+	_in_mask[in * _out_words + v] = 0;
+	_in_best[in * _out_words + v] = 0;
+      }
+      _in_best_pri[in] = numeric_limits<int>::min();
+    }
+    _in_occ[w] = 0;
+  }
+  for ( int w = 0; w < _out_words; ++w ) {
+    for ( word_t m = _out_occ[w]; m; m &= m - 1 ) {
+      int const out = ( w << 6 ) + __builtin_ctzll( m );
+      for ( int v = 0; v < _in_words; ++v ) {
+	_out_mask[out * _in_words + v] = 0;
+	_out_best[out * _in_words + v] = 0;
+      }
+      _out_best_pri[out] = numeric_limits<int>::min();
+    }
+    _out_occ[w] = 0;
+  }
+  Allocator::Clear( );
+}
+
+int BitSeparableAllocator::ReadRequest( int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( !_Test( &_in_mask[in * _out_words], out ) ) {
+    return -1;
+  }
+  return _request[in * _outputs + out].label;
+}
+
+bool BitSeparableAllocator::ReadRequest( sRequest &req, int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( !_Test( &_in_mask[in * _out_words], out ) ) {
+    return false;
+  }
+  req = _request[in * _outputs + out];
+  return true;
+}
+
+void BitSeparableAllocator::AddRequest( int in, int out, int label,
+					int in_pri, int out_pri )
+{
+  Allocator::AddRequest( in, out, label, in_pri, out_pri );
+  assert( !_Test( &_in_mask[in * _out_words], out ) );
+
+  sRequest & req = _request[in * _outputs + out];
+  req.port    = out;
+  req.label   = label;
+  req.in_pri  = in_pri;
+  req.out_pri = out_pri;
+
+  _Set( &_in_mask[in * _out_words], out );
+  _Set( &_out_mask[out * _in_words], in );
+  _Set( &_in_occ[0], in );
+  _Set( &_out_occ[0], out );
+
+  _AddBest( &_in_best[in * _out_words], _out_words, _in_best_pri[in],
+	    out, in_pri );
+  _AddBest( &_out_best[out * _in_words], _in_words, _out_best_pri[out],
+	    in, out_pri );
+}
+
+void BitSeparableAllocator::RemoveRequest( int in, int out, int label )
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+  assert( _Test( &_in_mask[in * _out_words], out ) );
+  assert( _request[in * _outputs + out].label == label );
+
+  _Reset( &_in_mask[in * _out_words], out );
+  _Reset( &_out_mask[out * _in_words], in );
+
+  if ( _Empty( &_in_mask[in * _out_words], _out_words ) ) {
+    _Reset( &_in_occ[0], in );
+  }
+  if ( _Empty( &_out_mask[out * _in_words], _in_words ) ) {
+    _Reset( &_out_occ[0], out );
+  }
+
+  if ( _Test( &_in_best[in * _out_words], out ) ) {
+    _RebuildInBest( in );
+  }
+  if ( _Test( &_out_best[out * _in_words], in ) ) {
+    _RebuildOutBest( out );
+  }
+}
+
+bool BitSeparableAllocator::InputHasRequests( int in ) const
+{
+  return _Test( &_in_occ[0], in );
+}
+
+bool BitSeparableAllocator::OutputHasRequests( int out ) const
+{
+  return _Test( &_out_occ[0], out );
+}
+
+int BitSeparableAllocator::NumInputRequests( int in ) const
+{
+  return _Count( &_in_mask[in * _out_words], _out_words );
+}
+
+int BitSeparableAllocator::NumOutputRequests( int out ) const
+{
+  return _Count( &_out_mask[out * _in_words], _in_words );
+}
+
+void BitSeparableAllocator::PrintRequests( ostream * os ) const
+{
+  if(!os) os = &cout;
+
+  *os << "Input requests = [ ";
+  for ( int input = 0; input < _inputs; ++input ) {
+    if ( InputHasRequests( input ) ) {
+      *os << input << " -> [ ";
+      for ( int output = 0; output < _outputs; ++output ) {
+	if ( _Test( &_in_mask[input * _out_words], output ) ) {
+	  *os << output << "@" << _request[input * _outputs + output].in_pri << " ";
+	}
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "], output requests = [ ";
+  for ( int output = 0; output < _outputs; ++output ) {
+    if ( OutputHasRequests( output ) ) {
+      *os << output << " -> [ ";
+      for ( int input = 0; input < _inputs; ++input ) {
+	if ( _Test( &_out_mask[output * _in_words], input ) ) {
+	  *os << input << "@" << _request[input * _outputs + output].out_pri << " ";
+	}
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "]." << endl;
+}
+
+void BitSeparableAllocator::Save( CheckpointWriter & w ) const
+{
+  w.Write( _in_ptr );
+  w.Write( _out_ptr );
+}
+
+void BitSeparableAllocator::Load( CheckpointReader & r )
+{
+  r.Expect( _inputs, "allocator inputs" );
+  for ( int i = 0; i < _inputs; ++i ) {
+    r.Read( _in_ptr[i] );
+  }
+  r.Expect( _outputs, "allocator outputs" );
+  for ( int o = 0; o < _outputs; ++o ) {
+    r.Read( _out_ptr[o] );
+  }
+}
@@ -0,0 +1,131 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// ----------------------------------------------------------------------
+//
+//  BitSeparableAllocator: Bit-Parallel Separable Allocator Base Class
+//
+//  Requests are kept as packed bit rows (one row of outputs per input
+//  and one row of inputs per output), and the round-robin arbiters
+//  are replaced by a pointer per port and a masked count-trailing-zeros
+//  over the row. Grants are identical to the separable allocators with
+//  round-robin arbiters.
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BIT_SEPARABLE_HPP_
+#define _BIT_SEPARABLE_HPP_
+
+#include <vector>
+
+#include "allocator.hpp"
+
+class BitSeparableAllocator : public Allocator {
+
+protected:
+
+  typedef unsigned long long word_t;
+
+  const int _in_words;  // words in a row of inputs
+  const int _out_words; // words in a row of outputs
+
+  // request data, valid where the corresponding bit of _in_mask is set
+  vector<sRequest> _request;
+
+  vector<word_t> _in_mask;  // inputs x _out_words
+  vector<word_t> _out_mask; // outputs x _in_words
+
+  // requests carrying the highest priority of each input/output
+  vector<word_t> _in_best;
+  vector<word_t> _out_best;
+  vector<int> _in_best_pri;
+  vector<int> _out_best_pri;
+
+  vector<word_t> _in_occ;
+  vector<word_t> _out_occ;
+
+  // first-stage grants, gathered like the requests above
+  vector<word_t> _grant;
+  vector<int> _grant_pri;
+
+  // round-robin pointers
+  vector<int> _in_ptr;
+  vector<int> _out_ptr;
+
+  static inline bool _Test( word_t const * row, int i ) {
+    return ( row[i >> 6] >> ( i & 63 ) ) & 1;
+  }
+  static inline void _Set( word_t * row, int i ) {
+    row[i >> 6] |= ( 1ULL << ( i & 63 ) );
+  }
+  static inline void _Reset( word_t * row, int i ) {
+    row[i >> 6] &= ~( 1ULL << ( i & 63 ) );
+  }
+  static bool _Empty( word_t const * row, int words );
+  static int _Count( word_t const * row, int words );
+
+  // first set bit at or after ptr, wrapping around; -1 if none
+  static int _RoundRobin( word_t const * row, int words, int ptr );
+
+  // add i to a priority row, replacing its contents if pri is higher
+  static void _AddBest( word_t * row, int words, int & best_pri,
+			int i, int pri );
+
+  void _RebuildInBest( int in );
+  void _RebuildOutBest( int out );
+
+  void _Match( int in, int out );
+
+public:
+
+  BitSeparableAllocator( Module* parent, const string& name, int inputs,
+			 int outputs );
+
+  virtual void Clear( );
+
+  int  ReadRequest( int in, int out ) const;
+  bool ReadRequest( sRequest &req, int in, int out ) const;
+
+  void AddRequest( int in, int out, int label = 1,
+		   int in_pri = 0, int out_pri = 0 );
+  void RemoveRequest( int in, int out, int label = 1 );
+
+  bool OutputHasRequests( int out ) const;
+  bool InputHasRequests( int in ) const;
+
+  int NumOutputRequests( int out ) const;
+  int NumInputRequests( int in ) const;
+
+  void PrintRequests( ostream * os = NULL ) const;
+
+  virtual void Save( CheckpointWriter & w ) const;
+  virtual void Load( CheckpointReader & r );
+
+};
+
+#endif
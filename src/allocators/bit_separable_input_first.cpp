@@ -0,0 +1,83 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// ----------------------------------------------------------------------
+//
+//  BitSeparableInputFirstAllocator: Bit-Parallel Separable Input-First
+//  Allocator
+//
+// ----------------------------------------------------------------------
+
+#include "bit_separable_input_first.hpp"
+
+#include <limits>
+#include <cassert>
+
+BitSeparableInputFirstAllocator::
+BitSeparableInputFirstAllocator( Module* parent, const string& name,
+				int inputs, int outputs )
+  : BitSeparableAllocator( parent, name, inputs, outputs )
+{}
+
+void BitSeparableInputFirstAllocator::Allocate( ) {
+
+  // Each input picks among its highest-priority requests and forwards
+  // the grant to the output.
+
+  for ( int w = 0; w < _in_words; ++w ) {
+    for ( word_t m = _in_occ[w]; m; m &= m - 1 ) {
+      int const input = ( w << 6 ) + __builtin_ctzll( m );
+
+      int const output = _RoundRobin( &_in_best[input * _out_words],
+				      _out_words, _in_ptr[input] );
+      assert( output > -1 );
+
+      _AddBest( &_grant[output * _in_words], _in_words, _grant_pri[output],
+		input, _request[input * _outputs + output].out_pri );
+    }
+  }
+
+  // Each output picks among the inputs that selected it.
+
+  for ( int w = 0; w < _out_words; ++w ) {
+    for ( word_t m = _out_occ[w]; m; m &= m - 1 ) {
+      int const output = ( w << 6 ) + __builtin_ctzll( m );
+
+      word_t * const grants = &_grant[output * _in_words];
+      int const input = _RoundRobin( grants, _in_words, _out_ptr[output] );
+
+      if ( input > -1 ) {
+	_Match( input, output );
+	for ( int v = 0; v < _in_words; ++v ) {
+	  grants[v] = 0;
+	}
+	_grant_pri[output] = numeric_limits<int>::min();
+      }
+    }
+  }
+}
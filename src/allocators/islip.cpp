@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "islip.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_ISLIP
@@ -181,3 +182,15 @@ void iSLIP_Sparse::Allocate( )
   cout << endl;
 #endif
 }
+
+void iSLIP_Sparse::Save( CheckpointWriter & w ) const
+{
+  w.Write( _gptrs );
+  w.Write( _aptrs );
+}
+
+void iSLIP_Sparse::Load( CheckpointReader & r )
+{
+  r.Read( _gptrs );
+  r.Read( _aptrs );
+}
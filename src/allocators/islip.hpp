@@ -43,6 +43,8 @@ public:
 		int inputs, int outputs, int iters );
 
   void Allocate( );
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
 };
 
 #endif 
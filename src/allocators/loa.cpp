@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "loa.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 LOA::LOA( Module *parent, const string& name,
@@ -109,4 +110,14 @@ void LOA::Allocate( )
 
 }
 
+void LOA::Save( CheckpointWriter & w ) const
+{
+  w.Write( _rptr );
+  w.Write( _gptr );
+}
 
+void LOA::Load( CheckpointReader & r )
+{
+  r.Read( _rptr );
+  r.Read( _gptr );
+}
@@ -44,6 +44,8 @@ public:
        int inputs, int outputs );
 
   void Allocate( );
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
 };
 
 #endif
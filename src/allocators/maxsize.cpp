@@ -33,6 +33,7 @@
 #include <iostream>
 
 #include "maxsize.hpp"
+#include "checkpoint.hpp"
 
 // shortest augmenting path:
 //
@@ -208,3 +209,13 @@ bool MaxSizeMatch::_ShortestAugmenting( )
 
   return true;
 }
+
+void MaxSizeMatch::Save( CheckpointWriter & w ) const
+{
+  w.Write( _prio );
+}
+
+void MaxSizeMatch::Load( CheckpointReader & r )
+{
+  r.Read( _prio );
+}
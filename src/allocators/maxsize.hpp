@@ -46,6 +46,8 @@ public:
   ~MaxSizeMatch( );
   
   void Allocate( );
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
 };
 
 #endif 
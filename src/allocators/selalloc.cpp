@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "selalloc.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_SELALLOC
@@ -252,3 +253,16 @@ void SelAlloc::PrintRequests( ostream * os ) const
   *os << "]." << endl;
 }
 
+void SelAlloc::Save( CheckpointWriter & w ) const
+{
+  w.Write( _aptrs );
+  w.Write( _gptrs );
+  w.Write( _outmask );
+}
+
+void SelAlloc::Load( CheckpointReader & r )
+{
+  r.Read( _aptrs );
+  r.Read( _gptrs );
+  r.Read( _outmask );
+}
@@ -45,6 +45,8 @@ public:
 	    int inputs, int outputs, int iters );
 
   void Allocate( );
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
 
   void MaskOutput( int out, int mask = 1 );
 
@@ -36,6 +36,7 @@
 #include <sstream>
 
 #include "arbiter.hpp"
+#include "checkpoint.hpp"
 
 SeparableAllocator::SeparableAllocator( Module* parent, const string& name,
 					int inputs, int outputs,
@@ -84,3 +85,23 @@ void SeparableAllocator::Clear() {
   }
   SparseAllocator::Clear();
 }
+
+void SeparableAllocator::Save( CheckpointWriter & w ) const
+{
+  for ( int i = 0; i < _inputs; ++i ) {
+    _input_arb[i]->Save( w );
+  }
+  for ( int o = 0; o < _outputs; ++o ) {
+    _output_arb[o]->Save( w );
+  }
+}
+
+void SeparableAllocator::Load( CheckpointReader & r )
+{
+  for ( int i = 0; i < _inputs; ++i ) {
+    _input_arb[i]->Load( r );
+  }
+  for ( int o = 0; o < _outputs; ++o ) {
+    _output_arb[o]->Load( r );
+  }
+}
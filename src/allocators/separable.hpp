@@ -56,6 +56,9 @@ public:
 
   virtual void Clear() ;
 
+  virtual void Save( CheckpointWriter & w ) const ;
+  virtual void Load( CheckpointReader & r ) ;
+
 } ;
 
 #endif
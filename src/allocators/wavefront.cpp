@@ -33,6 +33,7 @@
 #include "booksim.hpp"
 
 #include "wavefront.hpp"
+#include "checkpoint.hpp"
 
 Wavefront::Wavefront( Module *parent, const string& name,
 		      int inputs, int outputs, bool skip_diags ) :
@@ -108,4 +109,12 @@ void Wavefront::Allocate( )
   _pri = ( ( _skip_diags ? first_diag : _pri ) + 1 ) % _square;
 }
 
+void Wavefront::Save( CheckpointWriter & w ) const
+{
+  w.Write( _pri );
+}
 
+void Wavefront::Load( CheckpointReader & r )
+{
+  r.Read( _pri );
+}
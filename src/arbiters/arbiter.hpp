@@ -38,6 +38,9 @@
 
 #include "module.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class Arbiter : public Module {
 
 protected:
@@ -75,6 +78,10 @@ public:
 
   virtual void Clear();
 
+  // priority state kept across cycles
+  virtual void Save( CheckpointWriter & w ) const {}
+  virtual void Load( CheckpointReader & r ) {}
+
   inline int LastWinner() const {
     return _selected;
   }
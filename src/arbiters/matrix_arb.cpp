@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "matrix_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 using namespace std ;
 
@@ -119,3 +120,13 @@ void MatrixArbiter::Clear()
   _last_req = -1;
   Arbiter::Clear();
 }
+
+void MatrixArbiter::Save( CheckpointWriter & w ) const
+{
+  w.Write( _matrix );
+}
+
+void MatrixArbiter::Load( CheckpointReader & r )
+{
+  r.Read( _matrix );
+}
@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "roundrobin_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 #include <limits>
 
@@ -78,3 +79,13 @@ void RoundRobinArbiter::Clear()
   _best_input = -1;
   Arbiter::Clear();
 }
+
+void RoundRobinArbiter::Save( CheckpointWriter & w ) const
+{
+  w.Write( _pointer );
+}
+
+void RoundRobinArbiter::Load( CheckpointReader & r )
+{
+  r.Read( _pointer );
+}
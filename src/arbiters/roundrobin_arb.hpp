@@ -60,6 +60,9 @@ public:
 
   virtual void Clear();
 
+  virtual void Save( CheckpointWriter & w ) const ;
+  virtual void Load( CheckpointReader & r ) ;
+
   static inline bool Supersedes(int input1, int pri1, int input2, int pri2, int offset, int size)
   {
     // in a round-robin scheme with the given number of positions and current 
@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "tree_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 #include <sstream>
 
@@ -117,3 +118,19 @@ void TreeArbiter::Clear()
   _global_arbiter->Clear();
   Arbiter::Clear();
 }
+
+void TreeArbiter::Save( CheckpointWriter & w ) const
+{
+  for ( size_t g = 0; g < _group_arbiters.size( ); ++g ) {
+    _group_arbiters[g]->Save( w );
+  }
+  _global_arbiter->Save( w );
+}
+
+void TreeArbiter::Load( CheckpointReader & r )
+{
+  for ( size_t g = 0; g < _group_arbiters.size( ); ++g ) {
+    _group_arbiters[g]->Load( r );
+  }
+  _global_arbiter->Load( r );
+}
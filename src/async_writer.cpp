@@ -0,0 +1,97 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "booksim.hpp"
+#include <iostream>
+#include <cstdlib>
+
+#include "async_writer.hpp"
+
+// buffers waiting for the disk before Flush() blocks
+static size_t const gMaxPending = 4;
+
+AsyncWriter::AsyncWriter( string const & filename, size_t chunk )
+  : _chunk( chunk ), _stop( false )
+{
+  _file = fopen( filename.c_str( ), "w" );
+  if ( !_file ) {
+    cout << "Error: Unable to open " << filename << " for writing." << endl;
+    exit(-1);
+  }
+  _buffer.reserve( _chunk );
+  _thread = thread( &AsyncWriter::_Work, this );
+}
+
+AsyncWriter::~AsyncWriter( )
+{
+  Flush( );
+  {
+    lock_guard<mutex> guard( _lock );
+    _stop = true;
+  }
+  _ready.notify_one( );
+  _thread.join( );
+  fclose( _file );
+}
+
+void AsyncWriter::Flush( )
+{
+  if ( _buffer.empty( ) ) {
+    return;
+  }
+  {
+    unique_lock<mutex> guard( _lock );
+    while ( _pending.size( ) >= gMaxPending ) {
+      _done.wait( guard );
+    }
+    _pending.push_back( string( ) );
+    _pending.back( ).swap( _buffer );
+  }
+  _ready.notify_one( );
+  _buffer.reserve( _chunk );
+}
+
+void AsyncWriter::_Work( )
+{
+  unique_lock<mutex> guard( _lock );
+  while ( true ) {
+    while ( _pending.empty( ) && !_stop ) {
+      _ready.wait( guard );
+    }
+    if ( _pending.empty( ) ) {
+      break;
+    }
+    string chunk;
+    chunk.swap( _pending.front( ) );
+    _pending.pop_front( );
+    guard.unlock( );
+    _done.notify_one( );
+    fwrite( chunk.data( ), 1, chunk.size( ), _file );
+    guard.lock( );
+  }
+}
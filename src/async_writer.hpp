@@ -0,0 +1,82 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*async_writer.hpp
+ *
+ *Appends text to a file from a background thread. Writes fill a buffer in
+ *memory; full buffers are handed to the writer thread, so the simulation
+ *only blocks when the disk falls more than a few buffers behind
+ *
+ */
+
+#ifndef _ASYNC_WRITER_HPP_
+#define _ASYNC_WRITER_HPP_
+
+#include <cstdio>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+class AsyncWriter {
+
+  FILE * _file;
+  size_t _chunk;
+
+  string _buffer;
+
+  mutex _lock;
+  condition_variable _ready;
+  condition_variable _done;
+  deque<string> _pending;
+  bool _stop;
+  thread _thread;
+
+  void _Work( );
+
+public:
+
+  AsyncWriter( string const & filename, size_t chunk = 1 << 20 );
+  ~AsyncWriter( );
+
+  inline void Write( string const & s ) {
+    _buffer += s;
+    if ( _buffer.size( ) >= _chunk ) {
+      Flush( );
+    }
+  }
+
+  // hand the buffered text to the writer thread
+  void Flush( );
+
+};
+
+#endif
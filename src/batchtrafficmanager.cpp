@@ -45,6 +45,13 @@ BatchTrafficManager::BatchTrafficManager( const Configuration &config,
   _batch_size = config.GetInt( "batch_size" );
   _batch_count = config.GetInt( "batch_count" );
 
+  if(!_checkpoint_out.empty() || !_checkpoint_in.empty()) {
+    Error("Checkpoints are not supported in batch mode.");
+  }
+  if(_trace) {
+    Error("Trace replay is not supported in batch mode.");
+  }
+
   _batch_time = new Stats( this, "batch_time", 1.0, 1000 );
   _stats["batch_time"] = _batch_time;
   
@@ -196,6 +203,12 @@ string BatchTrafficManager::_OverallStatsCSV(int c) const
   return os.str();
 }
 
+string BatchTrafficManager::_OverallStatsCSVHeader() const
+{
+  return TrafficManager::_OverallStatsCSVHeader() +
+    ",min_batch_time,avg_batch_time,max_batch_time";
+}
+
 void BatchTrafficManager::WriteStats(ostream & os) const
 {
   TrafficManager::WriteStats(os);
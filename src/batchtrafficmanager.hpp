@@ -60,6 +60,7 @@ protected:
   virtual void _UpdateOverallStats( );
 
   virtual string _OverallStatsCSV(int c = 0) const;
+  virtual string _OverallStatsCSVHeader() const;
 
 public:
 
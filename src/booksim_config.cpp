@@ -188,12 +188,51 @@ BookSimConfig::BookSimConfig( )
   _int_map["batch_count"] = 1;
   _int_map["max_outstanding_requests"] = 0; // 0 = unlimited
 
+  // CSV time series of link utilization, credits in use and buffer
+  // occupancy, one row every util_sample_period cycles
+  AddStrField("util_out", "");
+  _int_map["util_sample_period"] = 100;
+
+  // print wall time per simulation phase, for iq routers per pipeline
+  // stage, and the flit pool size at the end of the run
+  _int_map["profile"] = 0;
+
+  // multicast: the L2 slices (l2slice nodes after the first sm nodes)
+  // inject class mcast_class as multicasts to a random group of
+  // mcast_group consecutive SMs (0 = all SMs), which iq routers replicate
+  // where the routes to the group diverge; mcast_unicast sends one packet
+  // per destination instead
+  _int_map["mcast_class"] = -1;
+  _int_map["mcast_group"] = 0;
+  _int_map["mcast_unicast"] = 0;
+
+  // sim_type = kernel: each SM issues kernel_requests read/write requests
+  // per phase, and phases are separated by a barrier on their replies
+  _int_map["kernel_requests"] = 64;
+  _int_map["kernel_count"] = 1;
+
   // Use read/write request reply scheme
   _int_map["use_read_write"] = 0;
   AddStrField("use_read_write", ""); // workaraound to allow for vector specification
   _float_map["write_fraction"] = 0.5;
   AddStrField("write_fraction", "");
 
+  // closed-loop read/write traffic: outstanding requests per source, and
+  // service latency, requests started per cycle and queue size at the
+  // request destinations (0: unlimited)
+  _int_map["mshrs"] = 0;
+  _int_map["l2_latency"] = 0;
+  _int_map["l2_bandwidth"] = 0;
+  _int_map["l2_queue_size"] = 0;
+
+  // with flit_width > 0 (bytes), the read/write packet sizes are derived
+  // from header_bytes plus line_bytes for read replies and write_bytes
+  // (0: line_bytes) for write requests; traced accesses carry their size
+  _int_map["flit_width"] = 0;
+  _int_map["header_bytes"] = 8;
+  _int_map["line_bytes"] = 128;
+  _int_map["write_bytes"] = 0;
+
   // Control assignment of packets to VCs
   _int_map["read_request_begin_vc"] = 0;
   _int_map["read_request_end_vc"] = 5;
@@ -257,6 +296,31 @@ BookSimConfig::BookSimConfig( )
 
   _int_map["sim_count"]     = 1;   // number of simulations to perform
 
+  // worker threads used to step the routers and channels of each network;
+  // only deterministic routing functions and allocators give results
+  // identical to the serial engine; watch traces, some topologies and
+  // adaptive GPUNet routing with routing_delay = 0 force a single thread
+  _int_map["threads"] = 1;
+
+  // skip stepping the network on cycles where nothing is in flight
+  _int_map["fast_forward"] = 0;
+
+  // load-latency sweep: one simulation per injection rate, run concurrently;
+  // rates come from the sweep_rates list or from the min/max/step range,
+  // and rates above the first unstable one are skipped
+  AddStrField("sweep_rates", "");
+  _float_map["sweep_rate_min"] = 0.0;
+  _float_map["sweep_rate_max"] = 0.0;
+  _float_map["sweep_rate_step"] = 0.0;
+  _int_map["sweep_threads"] = 0; // 0: one per hardware thread
+  AddStrField("sweep_out", "sweep.csv");
+
+  // write the warmed-up state of the first simulation to checkpoint_out, or
+  // start measuring right away from a checkpoint_in written by the same
+  // configuration
+  AddStrField("checkpoint_out", "");
+  AddStrField("checkpoint_in", "");
+
 
   _int_map["include_queuing"] =1; // non-zero includes source queuing latency
 
@@ -286,7 +350,13 @@ BookSimConfig::BookSimConfig( )
 
   AddStrField("stats_out", "");
 
-#ifdef TRACK_FLOWS
+  // per-class flow, stall and buffer occupancy instrumentation; the
+  // *_out files below are only written when the matching option is set
+  _int_map["track_flows"] = 0;
+  _int_map["track_stalls"] = 0;
+  _int_map["track_buffers"] = 0;
+  _int_map["track_credits"] = 0;
+
   AddStrField("injected_flits_out", "");
   AddStrField("received_flits_out", "");
   AddStrField("stored_flits_out", "");
@@ -294,13 +364,10 @@ BookSimConfig::BookSimConfig( )
   AddStrField("outstanding_credits_out", "");
   AddStrField("ejected_flits_out", "");
   AddStrField("active_packets_out", "");
-#endif
 
-#ifdef TRACK_CREDITS
   AddStrField("used_credits_out", "");
   AddStrField("free_credits_out", "");
   AddStrField("max_credits_out", "");
-#endif
 
   // batch only -- packet sequence numbers
   AddStrField("sent_packets_out", "");
@@ -326,6 +393,49 @@ BookSimConfig::BookSimConfig( )
   _int_map["speedups"] = 1;
   AddStrField("speedups", "");
   _int_map["inter_partition_speedup"] = 1;
+  // with flit_width, per-layer (as speedups) and inter-partition link
+  // widths in bytes per cycle set the speedups instead
+  _int_map["layer_widths"] = 0;
+  AddStrField("layer_widths", "");
+  _int_map["inter_partition_width"] = 0;
+
+  // GPUNet floorplan: placements give channel latencies from wire_delay
+  // (cycles per unit of Manhattan distance) and can override bandwidths
+  AddStrField("floorplan_file", "");
+  _float_map["wire_delay"] = 1.0;
+
+  // multi-die GPUNet: sm and l2slice are split evenly across the dies,
+  // and each partition crossbar links to its peers on the other dies
+  _int_map["dies"] = 1;
+  _int_map["die_latency"] = 8;
+  _int_map["die_bandwidth"] = 1;
+  _int_map["die_vc_buf_size"] = 0; // 0: same as vc_buf_size
+
+  // adaptive GPUNet routing detours around a partition link once its used
+  // credits exceed twice those of the detour plus this bias
+  _int_map["adaptive_threshold"] = 8;
+
+  // mapping of memory addresses to L2 slices: "interleave" or "xor" over
+  // blocks of l2_interleave bytes, or "select" of the l2_hash_bits
+  AddStrField("l2_hash", "interleave");
+  _int_map["l2_interleave"] = 256;
+  AddStrField("l2_hash_bits", "");
+
+  // gpu_interleave traffic: synthetic addresses (random, or strided by
+  // gpu_stride blocks per SM) hashed to L2 slices; if gpu_local_fraction
+  // is not negative, that share of the requests goes to the SM's own
+  // partition and the rest only to the other partitions
+  _float_map["gpu_local_fraction"] = -1.0;
+  _int_map["gpu_stride"] = 0;
+
+  // memory trace replay: requests of class trace_class come from the
+  // records of trace_file instead of the injection process; records at
+  // most trace_lookahead cycles ahead and at most trace_buffer of them
+  // are held in memory
+  AddStrField("trace_file", "");
+  _int_map["trace_class"] = 0;
+  _int_map["trace_lookahead"] = 1000;
+  _int_map["trace_buffer"] = 65536;
 }
 
 
@@ -30,12 +30,14 @@
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "buffer.hpp"
+#include "checkpoint.hpp"
 
 Buffer::Buffer( const Configuration& config, int outputs,
 		Module *parent, const string& name, int bandwidth )  :
 Module( parent, name ), _occupancy(0)
 {
   int num_vcs = config.GetInt( "num_vcs" );
+  _track_buffers = (config.GetInt("track_buffers") > 0);
 
   _size = config.GetInt("buf_size");
   if(_size < 0) {
@@ -50,10 +52,10 @@ Module( parent, name ), _occupancy(0)
     _vc[i] = new VC(config, outputs, this, vc_name.str( ) );
   }
 
-#ifdef TRACK_BUFFERS
-  int classes = config.GetInt("classes");
-  _class_occupancy.resize(classes, 0);
-#endif
+  if(_track_buffers) {
+    int classes = config.GetInt("classes");
+    _class_occupancy.resize(classes, 0);
+  }
 }
 
 Buffer::~Buffer()
@@ -70,9 +72,47 @@ void Buffer::AddFlit( int vc, Flit *f )
   }
   ++_occupancy;
   _vc[vc]->AddFlit(f);
-#ifdef TRACK_BUFFERS
-  ++_class_occupancy[f->cl];
-#endif
+  if(_track_buffers) {
+    ++_class_occupancy[f->cl];
+  }
+}
+
+void Buffer::RequeueFlits( int vc, vector<Flit *> const & flits )
+{
+  if(_occupancy + (int)flits.size() > _size) {
+    Error("Flit buffer overflow.");
+  }
+  _occupancy += flits.size();
+  _vc[vc]->RequeueFlits(flits);
+  if(_track_buffers) {
+    for(size_t i = 0; i < flits.size(); ++i) {
+      ++_class_occupancy[flits[i]->cl];
+    }
+  }
+}
+
+void Buffer::Save( CheckpointWriter & w ) const
+{
+  w.Write( (int)_vc.size( ) );
+  w.Write( _occupancy );
+  for(vector<VC*>::const_iterator i = _vc.begin(); i != _vc.end(); ++i) {
+    (*i)->Save( w );
+  }
+  if(_track_buffers) {
+    w.Write( _class_occupancy );
+  }
+}
+
+void Buffer::Load( CheckpointReader & r )
+{
+  r.Expect( _vc.size( ), "number of VCs" );
+  r.Read( _occupancy );
+  for(vector<VC*>::iterator i = _vc.begin(); i != _vc.end(); ++i) {
+    (*i)->Load( r );
+  }
+  if(_track_buffers) {
+    r.Read( _class_occupancy );
+  }
 }
 
 void Buffer::Display( ostream & os ) const
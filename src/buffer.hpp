@@ -36,6 +36,9 @@
 #include "routefunc.hpp"
 #include "config_utils.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class Buffer : public Module {
   
   int _occupancy;
@@ -43,9 +46,9 @@ class Buffer : public Module {
 
   vector<VC*> _vc;
 
-#ifdef TRACK_BUFFERS
+  // flits per class, kept only when track_buffers is set
+  bool _track_buffers;
   vector<int> _class_occupancy;
-#endif
 
 public:
   
@@ -55,14 +58,16 @@ public:
 
   void AddFlit( int vc, Flit *f );
 
+  void RequeueFlits( int vc, vector<Flit *> const & flits );
+
   inline Flit *RemoveFlit( int vc )
   {
     --_occupancy;
-#ifdef TRACK_BUFFERS
-    int cl = _vc[vc]->FrontFlit()->cl;
-    assert(_class_occupancy[cl] > 0);
-    --_class_occupancy[cl];
-#endif
+    if(_track_buffers) {
+      int cl = _vc[vc]->FrontFlit()->cl;
+      assert(_class_occupancy[cl] > 0);
+      --_class_occupancy[cl];
+    }
     return _vc[vc]->RemoveFlit( );
   }
   
@@ -126,6 +131,11 @@ public:
     _vc[vc]->Route(rf, router, f, in_channel);
   }
 
+  // ==== Checkpointing ====
+
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
+
   // ==== Debug functions ====
 
   inline void SetWatch( int vc, bool watch = true )
@@ -148,12 +158,10 @@ public:
     return _vc[vc]->GetOccupancy( );
   }
 
-#ifdef TRACK_BUFFERS
   inline int GetOccupancyForClass(int c) const
   {
     return _class_occupancy[c];
   }
-#endif
 
   void Display( ostream & os = cout ) const;
 };
@@ -41,6 +41,7 @@
 #include "buffer_state.hpp"
 #include "random_utils.hpp"
 #include "globals.hpp"
+#include "checkpoint.hpp"
 
 //#define DEBUG_FEEDBACK
 //#define DEBUG_SIMPLEFEEDBACK
@@ -261,6 +262,20 @@ int BufferState::SharedBufferPolicy::LimitFor(int vc) const
   return (_private_buf_size[i] + _shared_buf_size);
 }
 
+void BufferState::SharedBufferPolicy::Save(CheckpointWriter & w) const
+{
+  w.Write(_private_buf_occupancy);
+  w.Write(_shared_buf_occupancy);
+  w.Write(_reserved_slots);
+}
+
+void BufferState::SharedBufferPolicy::Load(CheckpointReader & r)
+{
+  r.Read(_private_buf_occupancy);
+  r.Read(_shared_buf_occupancy);
+  r.Read(_reserved_slots);
+}
+
 BufferState::LimitedSharedBufferPolicy::LimitedSharedBufferPolicy(Configuration const & config, BufferState * parent, const string & name)
   : SharedBufferPolicy(config, parent, name), _active_vcs(0)
 {
@@ -307,6 +322,20 @@ int BufferState::LimitedSharedBufferPolicy::LimitFor(int vc) const
   return min(SharedBufferPolicy::LimitFor(vc), _max_held_slots);
 }
 
+void BufferState::LimitedSharedBufferPolicy::Save(CheckpointWriter & w) const
+{
+  SharedBufferPolicy::Save(w);
+  w.Write(_active_vcs);
+  w.Write(_max_held_slots);
+}
+
+void BufferState::LimitedSharedBufferPolicy::Load(CheckpointReader & r)
+{
+  SharedBufferPolicy::Load(r);
+  r.Read(_active_vcs);
+  r.Read(_max_held_slots);
+}
+
 BufferState::DynamicLimitedSharedBufferPolicy::DynamicLimitedSharedBufferPolicy(Configuration const & config, BufferState * parent, const string & name)
   : LimitedSharedBufferPolicy(config, parent, name)
 {
@@ -489,6 +518,24 @@ int BufferState::FeedbackSharedBufferPolicy::LimitFor(int vc) const
   return min(SharedBufferPolicy::LimitFor(vc), _ComputeMaxSlots(vc));
 }
 
+void BufferState::FeedbackSharedBufferPolicy::Save(CheckpointWriter & w) const
+{
+  SharedBufferPolicy::Save(w);
+  w.Write(_occupancy_limit);
+  w.Write(_round_trip_time);
+  w.Write(_flit_sent_time);
+  w.Write(_min_latency);
+}
+
+void BufferState::FeedbackSharedBufferPolicy::Load(CheckpointReader & r)
+{
+  SharedBufferPolicy::Load(r);
+  r.Read(_occupancy_limit);
+  r.Read(_round_trip_time);
+  r.Read(_flit_sent_time);
+  r.Read(_min_latency);
+}
+
 BufferState::SimpleFeedbackSharedBufferPolicy::SimpleFeedbackSharedBufferPolicy(Configuration const & config, BufferState * parent, const string & name)
   : FeedbackSharedBufferPolicy(config, parent, name)
 {
@@ -536,10 +583,28 @@ void BufferState::SimpleFeedbackSharedBufferPolicy::FreeSlotFor(int vc)
   SharedBufferPolicy::FreeSlotFor(vc);
 }
 
+void BufferState::SimpleFeedbackSharedBufferPolicy::Save(CheckpointWriter & w) const
+{
+  FeedbackSharedBufferPolicy::Save(w);
+  w.Write(_pending_credits);
+}
+
+void BufferState::SimpleFeedbackSharedBufferPolicy::Load(CheckpointReader & r)
+{
+  FeedbackSharedBufferPolicy::Load(r);
+  r.Read(_pending_credits);
+}
+
 BufferState::BufferState( const Configuration& config, Module *parent, const string& name, int bandwidth ) : 
   Module( parent, name ), _occupancy(0)
 {
   _vcs = config.GetInt( "num_vcs" );
+  _track_buffers = (config.GetInt("track_buffers") > 0);
+  if(_vcs > Credit::MAX_VCS) {
+    ostringstream err;
+    err << "Credits support at most " << Credit::MAX_VCS << " VCs";
+    Error(err.str());
+  }
   _size = config.GetInt("buf_size");
   if(_size < 0) {
     _size = _vcs * config.GetInt("vc_buf_size");
@@ -557,11 +622,11 @@ BufferState::BufferState( const Configuration& config, Module *parent, const str
   _last_id.resize(_vcs, -1);
   _last_pid.resize(_vcs, -1);
 
-#ifdef TRACK_BUFFERS
-  _classes = config.GetInt("classes");
-  _outstanding_classes.resize(_vcs);
-  _class_occupancy.resize(_classes, 0);
-#endif
+  if(_track_buffers) {
+    _classes = config.GetInt("classes");
+    _outstanding_classes.resize(_vcs);
+    _class_occupancy.resize(_classes, 0);
+  }
 }
 
 BufferState::~BufferState()
@@ -573,46 +638,44 @@ void BufferState::ProcessCredit( Credit const * const c )
 {
   assert( c );
 
-  set<int>::iterator iter = c->vc.begin();
-  while(iter != c->vc.end()) {
-
-    int const vc = *iter;
+  for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
 
     assert( ( vc >= 0 ) && ( vc < _vcs ) );
 
-    if ( ( _wait_for_tail_credit ) && 
-	 ( _in_use_by[vc] < 0 ) ) {
-      ostringstream err;
-      err << "Received credit for idle VC " << vc;
-      Error( err.str() );
-    }
-    --_occupancy;
-    if(_occupancy < 0) {
-      Error("Buffer occupancy fell below zero.");
-    }
-    --_vc_occupancy[vc];
-    if(_vc_occupancy[vc] < 0) {
-      ostringstream err;
-      err << "Buffer occupancy fell below zero for VC " << vc;
-      Error(err.str());
-    }
-    if(_wait_for_tail_credit && !_vc_occupancy[vc] && _tail_sent[vc]) {
-      assert(_in_use_by[vc] >= 0);
-      _in_use_by[vc] = -1;
-    }
+    for(int slot = 0; slot < c->Count(vc); ++slot) {
 
-#ifdef TRACK_BUFFERS
-    assert(!_outstanding_classes[vc].empty());
-    int cl = _outstanding_classes[vc].front();
-    _outstanding_classes[vc].pop();
-    assert((cl >= 0) && (cl < _classes));
-    assert(_class_occupancy[cl] > 0);
-    --_class_occupancy[cl];
-#endif
+      if ( ( _wait_for_tail_credit ) && 
+	   ( _in_use_by[vc] < 0 ) ) {
+	ostringstream err;
+	err << "Received credit for idle VC " << vc;
+	Error( err.str() );
+      }
+      --_occupancy;
+      if(_occupancy < 0) {
+	Error("Buffer occupancy fell below zero.");
+      }
+      --_vc_occupancy[vc];
+      if(_vc_occupancy[vc] < 0) {
+	ostringstream err;
+	err << "Buffer occupancy fell below zero for VC " << vc;
+	Error(err.str());
+      }
+      if(_wait_for_tail_credit && !_vc_occupancy[vc] && _tail_sent[vc]) {
+	assert(_in_use_by[vc] >= 0);
+	_in_use_by[vc] = -1;
+      }
 
-    _buffer_policy->FreeSlotFor(vc);
+      if(_track_buffers) {
+	assert(!_outstanding_classes[vc].empty());
+	int cl = _outstanding_classes[vc].front();
+	_outstanding_classes[vc].pop();
+	assert((cl >= 0) && (cl < _classes));
+	assert(_class_occupancy[cl] > 0);
+	--_class_occupancy[cl];
+      }
 
-    ++iter;
+      _buffer_policy->FreeSlotFor(vc);
+    }
   }
 }
 
@@ -632,10 +695,10 @@ void BufferState::SendingFlit( Flit const * const f )
   
   _buffer_policy->SendingFlit(f);
   
-#ifdef TRACK_BUFFERS
-  _outstanding_classes[vc].push(f->cl);
-  ++_class_occupancy[f->cl];
-#endif
+  if(_track_buffers) {
+    _outstanding_classes[vc].push(f->cl);
+    ++_class_occupancy[f->cl];
+  }
 
   if ( f->tail ) {
     _tail_sent[vc] = true;
@@ -663,6 +726,38 @@ void BufferState::TakeBuffer( int vc, int tag )
   _buffer_policy->TakeBuffer(vc);
 }
 
+void BufferState::Save( CheckpointWriter & w ) const
+{
+  w.Write( _vcs );
+  w.Write( _occupancy );
+  w.Write( _vc_occupancy );
+  w.Write( _in_use_by );
+  w.Write( _tail_sent );
+  w.Write( _last_id );
+  w.Write( _last_pid );
+  if(_track_buffers) {
+    w.Write( _outstanding_classes );
+    w.Write( _class_occupancy );
+  }
+  _buffer_policy->Save( w );
+}
+
+void BufferState::Load( CheckpointReader & r )
+{
+  r.Expect( _vcs, "number of VCs" );
+  r.Read( _occupancy );
+  r.Read( _vc_occupancy );
+  r.Read( _in_use_by );
+  r.Read( _tail_sent );
+  r.Read( _last_id );
+  r.Read( _last_pid );
+  if(_track_buffers) {
+    r.Read( _outstanding_classes );
+    r.Read( _class_occupancy );
+  }
+  _buffer_policy->Load( r );
+}
+
 void BufferState::Display( ostream & os ) const
 {
   os << FullName() << " :" << endl;
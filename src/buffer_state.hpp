@@ -36,6 +36,9 @@
 #include "credit.hpp"
 #include "config_utils.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class BufferState : public Module {
   
   class BufferPolicy : public Module {
@@ -51,6 +54,9 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const = 0;
     virtual int AvailableFor(int vc = 0) const = 0;
     virtual int LimitFor(int vc = 0) const = 0;
+    // dynamic state only; the default policy has none
+    virtual void Save(CheckpointWriter & w) const {}
+    virtual void Load(CheckpointReader & r) {}
 
     static BufferPolicy * New(Configuration const & config, 
 			      BufferState * parent, const string & name);
@@ -86,6 +92,8 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Save(CheckpointWriter & w) const;
+    virtual void Load(CheckpointReader & r);
   };
 
   class LimitedSharedBufferPolicy : public SharedBufferPolicy {
@@ -102,6 +110,8 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Save(CheckpointWriter & w) const;
+    virtual void Load(CheckpointReader & r);
   };
     
   class DynamicLimitedSharedBufferPolicy : public LimitedSharedBufferPolicy {
@@ -144,6 +154,8 @@ class BufferState : public Module {
     virtual bool IsFullFor(int vc = 0) const;
     virtual int AvailableFor(int vc = 0) const;
     virtual int LimitFor(int vc = 0) const;
+    virtual void Save(CheckpointWriter & w) const;
+    virtual void Load(CheckpointReader & r);
   };
   
   class SimpleFeedbackSharedBufferPolicy : public FeedbackSharedBufferPolicy {
@@ -154,6 +166,8 @@ class BufferState : public Module {
 				     BufferState * parent, const string & name);
     virtual void SendingFlit(Flit const * const f);
     virtual void FreeSlotFor(int vc = 0);
+    virtual void Save(CheckpointWriter & w) const;
+    virtual void Load(CheckpointReader & r);
   };
   
   bool _wait_for_tail_credit;
@@ -169,11 +183,11 @@ class BufferState : public Module {
   vector<int> _last_id;
   vector<int> _last_pid;
 
-#ifdef TRACK_BUFFERS
+  // credits in use per class, kept only when track_buffers is set
+  bool _track_buffers;
   int _classes;
   vector<queue<int> > _outstanding_classes;
   vector<int> _class_occupancy;
-#endif
 
 public:
 
@@ -191,6 +205,9 @@ public:
 
   void TakeBuffer( int vc = 0, int tag = 0 );
 
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
+
   inline bool IsFull() const {
     assert(_occupancy <= _size);
     return (_occupancy == _size);
@@ -226,12 +243,10 @@ public:
     return _vc_occupancy[vc];
   }
   
-#ifdef TRACK_BUFFERS
   inline int OccupancyForClass(int c) const {
     assert((c >= 0) && (c < _classes));
     return _class_occupancy[c];
   }
-#endif
 
   void Display( ostream & os = cout ) const;
 };
@@ -33,17 +33,24 @@
 //   transmission delay. The channel latency can be specified as 
 //   an integer number of simulator cycles.
 //
+//  Items in transit are kept in a preallocated ring of _delay + 1
+//   stages with _bandwidth slots each, indexed by the cycle in which
+//   they leave the channel, so no allocation happens per hop. The
+//   extra stage holds the current output while the next items are
+//   read in.
+//
 /////
 #ifndef _CHANNEL_HPP
 #define _CHANNEL_HPP
 
-#include <queue>
-#include <deque>
+#include <vector>
+#include <algorithm>
 #include <cassert>
 
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -69,19 +76,44 @@ public:
   virtual void Evaluate() {}
   virtual void WriteOutputs();
 
+  // items in transit between cycles
+  virtual void Save(CheckpointWriter & w) const;
+  virtual void Load(CheckpointReader & r);
+
 protected:
   int _delay;
   // # flits that can be trasmitted in a single cycle
   int _bandwidth;
-  deque<T *> _input;
-  deque<T *> _output;
-  queue<pair<int, deque<T *> > > _wait_queue;
+  vector<T *> _input;
+
+  // items released by the last WriteOutputs() that have not been received
+  inline int _OutputSize() const {
+    return (_release[_out_stage] == _out_time) ? 
+      (_count[_out_stage] - _out_pos) : 0;
+  }
+  inline T * _Output(int i) const {
+    return _ring[_out_stage * _slots + _out_pos + i];
+  }
+
+private:
+  int _stages;
+  int _slots;
+  vector<T *> _ring;
+  vector<int> _count;
+  // cycle in which the items of each stage leave the channel
+  vector<int> _release;
+  int _out_stage;
+  int _out_time;
+  int _out_pos;
 
+  void _Resize(int stages, int slots);
 };
 
 template<typename T>
 Channel<T>::Channel(Module * parent, string const & name)
-  : TimedModule(parent, name), _delay(1), _bandwidth(1), _input(0), _output(0) {
+  : TimedModule(parent, name), _delay(1), _bandwidth(1), _stages(0), 
+    _slots(0), _out_stage(0), _out_time(-1), _out_pos(0) {
+  _Resize(_delay + 1, _bandwidth);
 }
 
 template<typename T>
@@ -90,6 +122,7 @@ void Channel<T>::SetLatency(int cycles) {
     Error("Channel must have positive delay.");
   }
   _delay = cycles ;
+  _Resize(_delay + 1, _slots);
 }
 
 template<typename T>
@@ -98,6 +131,38 @@ void Channel<T>::SetBandwidth(int bandwidth) {
     Error("Channel bandwidth must be positive");
   }
   _bandwidth = bandwidth;
+  _Resize(_stages, max(_bandwidth, 1));
+}
+
+// stages are only remapped while the channel is empty (i.e. during network
+// construction); growing the slots keeps every item in its stage
+template<typename T>
+void Channel<T>::_Resize(int stages, int slots) {
+  if((stages == _stages) && (slots == _slots)) {
+    return;
+  }
+  if(stages != _stages) {
+    for(int s = 0; s < _stages; ++s) {
+      assert(_count[s] == 0);
+    }
+    _count.assign(stages, 0);
+    _release.assign(stages, -1);
+    _out_stage = 0;
+    _out_time = -1;
+    _out_pos = 0;
+  }
+  vector<T *> ring(stages * slots, (T *)NULL);
+  if(stages == _stages) {
+    for(int s = 0; s < _stages; ++s) {
+      for(int i = 0; i < _count[s]; ++i) {
+        ring[s * slots + i] = _ring[s * _slots + i];
+      }
+    }
+  }
+  _ring.swap(ring);
+  _stages = stages;
+  _slots = slots;
+  _input.reserve(_slots);
 }
 
 template<typename T>
@@ -109,37 +174,87 @@ void Channel<T>::Send(T * data) {
 
 template<typename T>
 T * Channel<T>::Receive() {
-  if (_output.empty()) {
+  if (_OutputSize() == 0) {
     return nullptr;
   }
-  T * data = _output.front();
-  _output.pop_front();
-  return data;
+  return _ring[_out_stage * _slots + _out_pos++];
 }
 
 template<typename T>
 void Channel<T>::ReadInputs() {
   if(!_input.empty()) {
-    _wait_queue.push(make_pair(GetSimTime() + _delay - 1, _input));
+    int const size = _input.size();
+    if(size > _slots) {
+      _Resize(_stages, size);
+    }
+    int const time = GetSimTime() + _delay - 1;
+    int const stage = time % _stages;
+    assert(_release[stage] < GetSimTime());
+    T ** const slot = &_ring[stage * _slots];
+    for(int i = 0; i < size; ++i) {
+      slot[i] = _input[i];
+    }
+    _count[stage] = size;
+    _release[stage] = time;
     _input.clear();
   }
 }
 
+// only items that have yet to be received are kept, packed to the front of
+// their stage
 template<typename T>
-void Channel<T>::WriteOutputs() {
-  _output.clear();
-  if(_wait_queue.empty()) {
-    return;
+void Channel<T>::Save(CheckpointWriter & w) const {
+  w.Write(_stages);
+  w.Write(_out_stage);
+  w.Write(_out_time);
+  for(int s = 0; s < _stages; ++s) {
+    int begin = 0;
+    int end = 0;
+    if((s == _out_stage) && (_release[s] == _out_time)) {
+      begin = _out_pos;
+      end = _count[s];
+    } else if(_release[s] > _out_time) {
+      end = _count[s];
+    }
+    w.Write(_release[s]);
+    w.Write(end - begin);
+    for(int i = begin; i < end; ++i) {
+      w.Write(_ring[s * _slots + i]);
+    }
   }
-  pair<int, deque<T *> > const & item = _wait_queue.front();
-  int const & time = item.first;
-  if(GetSimTime() < time) {
-    return;
+  w.Write(_input);
+}
+
+template<typename T>
+void Channel<T>::Load(CheckpointReader & r) {
+  r.Expect(_stages, "channel latency");
+  r.Read(_out_stage);
+  r.Read(_out_time);
+  _out_pos = 0;
+  for(int s = 0; s < _stages; ++s) {
+    int count;
+    r.Read(_release[s]);
+    r.Read(count);
+    if(count > _slots) {
+      _Resize(_stages, count);
+    }
+    for(int i = 0; i < count; ++i) {
+      r.Read(_ring[s * _slots + i]);
+    }
+    _count[s] = count;
+  }
+  r.Read(_input);
+}
+
+template<typename T>
+void Channel<T>::WriteOutputs() {
+  // anything not received during the last cycle is dropped
+  if(_release[_out_stage] == _out_time) {
+    _count[_out_stage] = 0;
   }
-  assert(GetSimTime() == time);
-  _output = item.second;
-  assert(!_output.empty());
-  _wait_queue.pop();
+  _out_time = GetSimTime();
+  _out_stage = _out_time % _stages;
+  _out_pos = 0;
 }
 
 #endif
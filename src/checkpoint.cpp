@@ -0,0 +1,324 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*checkpoint.cpp
+ *
+ *Object references are encoded as a tag (0: null, 1: reference to an
+ *object written before, 2: object follows) plus the object's index
+ *
+ */
+
+#include <cstdlib>
+
+#include "booksim.hpp"
+#include "checkpoint.hpp"
+#include "packet_reply_info.hpp"
+
+CheckpointWriter::CheckpointWriter( ostream & os )
+  : _os( os )
+{
+}
+
+void CheckpointWriter::Section( string const & name )
+{
+  Write( name );
+}
+
+void CheckpointWriter::Write( string const & s )
+{
+  Write( (int)s.size( ) );
+  _os.write( s.data( ), s.size( ) );
+}
+
+void CheckpointWriter::Write( OutputSet const & s )
+{
+  Write( s.Size( ) );
+  for ( OutputSet::const_iterator i = s.begin( ); i != s.end( ); ++i ) {
+    Write( i->output_port );
+    Write( i->vc_start );
+    Write( i->vc_end );
+    Write( i->pri );
+  }
+}
+
+void CheckpointWriter::Write( Flit const * f )
+{
+  if ( !f ) {
+    Write( 0 );
+    return;
+  }
+  map<Flit const *, int>::const_iterator const match = _flits.find( f );
+  if ( match != _flits.end( ) ) {
+    Write( 1 );
+    Write( match->second );
+    return;
+  }
+  int const index = _flits.size( );
+  _flits[f] = index;
+  Write( 2 );
+  Write( index );
+  Write( f->vc );
+  Write( f->cl );
+  Write( f->src );
+  Write( f->dest );
+  Write( f->pri );
+  Write( f->intm );
+  Write( f->ph );
+  Write( f->subnetwork );
+  Write( (int)f->type );
+  Write( f->hops );
+  Write( f->id );
+  Write( f->pid );
+  Write( f->head );
+  Write( f->tail );
+  Write( f->watch );
+  Write( f->record );
+  Write( f->la_route_set );
+  Write( f->ctime );
+  Write( f->itime );
+  Write( f->atime );
+}
+
+void CheckpointWriter::Write( Credit const * c )
+{
+  if ( !c ) {
+    Write( 0 );
+    return;
+  }
+  map<Credit const *, int>::const_iterator const match = _credits.find( c );
+  if ( match != _credits.end( ) ) {
+    Write( 1 );
+    Write( match->second );
+    return;
+  }
+  int const index = _credits.size( );
+  _credits[c] = index;
+  Write( 2 );
+  Write( index );
+  Write( c->head );
+  Write( c->tail );
+  Write( c->id );
+  Write( c->NumVCs( ) );
+  for ( int vc = c->FirstVC( ); vc >= 0; vc = c->NextVC( vc ) ) {
+    Write( vc );
+    Write( c->Count( vc ) );
+  }
+}
+
+void CheckpointWriter::Write( PacketReplyInfo const * r )
+{
+  if ( !r ) {
+    Write( 0 );
+    return;
+  }
+  map<PacketReplyInfo const *, int>::const_iterator const match = _replies.find( r );
+  if ( match != _replies.end( ) ) {
+    Write( 1 );
+    Write( match->second );
+    return;
+  }
+  int const index = _replies.size( );
+  _replies[r] = index;
+  Write( 2 );
+  Write( index );
+  Write( r->source );
+  Write( r->time );
+  Write( r->record );
+  Write( (int)r->type );
+}
+
+CheckpointReader::CheckpointReader( istream & is )
+  : _is( is )
+{
+}
+
+void CheckpointReader::_Fail( string const & msg ) const
+{
+  cout << "Error: Cannot restore checkpoint: " << msg << "." << endl;
+  exit(-1);
+}
+
+void CheckpointReader::Section( string const & name )
+{
+  string found;
+  Read( found );
+  if ( found != name ) {
+    _Fail( "expected section " + name + ", found " + found );
+  }
+}
+
+void CheckpointReader::Expect( int v, string const & what )
+{
+  int found;
+  Read( found );
+  if ( found != v ) {
+    _Fail( what + " differs from the simulated configuration" );
+  }
+}
+
+void CheckpointReader::Read( string & s )
+{
+  int size;
+  Read( size );
+  if ( ( size < 0 ) || ( size > ( 1 << 16 ) ) ) {
+    _Fail( "corrupt string" );
+  }
+  s.resize( size );
+  _is.read( &s[0], size );
+  if ( !_is ) {
+    _Fail( "unexpected end of checkpoint" );
+  }
+}
+
+void CheckpointReader::Read( OutputSet & s )
+{
+  int size;
+  Read( size );
+  s.Clear( );
+  for ( int i = 0; i < size; ++i ) {
+    int output_port, vc_start, vc_end, pri;
+    Read( output_port );
+    Read( vc_start );
+    Read( vc_end );
+    Read( pri );
+    s.AddRange( output_port, vc_start, vc_end, pri );
+  }
+}
+
+void CheckpointReader::Read( Flit * & f )
+{
+  int tag, index;
+  Read( tag );
+  if ( tag == 0 ) {
+    f = NULL;
+    return;
+  }
+  Read( index );
+  if ( tag == 1 ) {
+    if ( ( index < 0 ) || ( index >= (int)_flits.size( ) ) ) {
+      _Fail( "corrupt flit reference" );
+    }
+    f = _flits[index];
+    return;
+  }
+  if ( index != (int)_flits.size( ) ) {
+    _Fail( "corrupt flit" );
+  }
+  f = Flit::New( );
+  _flits.push_back( f );
+  int type;
+  Read( f->vc );
+  Read( f->cl );
+  Read( f->src );
+  Read( f->dest );
+  Read( f->pri );
+  Read( f->intm );
+  Read( f->ph );
+  Read( f->subnetwork );
+  Read( type );
+  f->type = (Flit::FlitType)type;
+  Read( f->hops );
+  Read( f->id );
+  Read( f->pid );
+  Read( f->head );
+  Read( f->tail );
+  Read( f->watch );
+  Read( f->record );
+  Read( f->la_route_set );
+  Read( f->ctime );
+  Read( f->itime );
+  Read( f->atime );
+}
+
+void CheckpointReader::Read( Credit * & c )
+{
+  int tag, index;
+  Read( tag );
+  if ( tag == 0 ) {
+    c = NULL;
+    return;
+  }
+  Read( index );
+  if ( tag == 1 ) {
+    if ( ( index < 0 ) || ( index >= (int)_credits.size( ) ) ) {
+      _Fail( "corrupt credit reference" );
+    }
+    c = _credits[index];
+    return;
+  }
+  if ( index != (int)_credits.size( ) ) {
+    _Fail( "corrupt credit" );
+  }
+  c = Credit::New( );
+  _credits.push_back( c );
+  Read( c->head );
+  Read( c->tail );
+  Read( c->id );
+  int vcs;
+  Read( vcs );
+  for ( int i = 0; i < vcs; ++i ) {
+    int vc, count;
+    Read( vc );
+    Read( count );
+    if ( ( vc < 0 ) || ( vc >= Credit::MAX_VCS ) ) {
+      _Fail( "corrupt credit" );
+    }
+    while ( count-- > 0 ) {
+      c->AddVC( vc );
+    }
+  }
+}
+
+void CheckpointReader::Read( PacketReplyInfo * & r )
+{
+  int tag, index;
+  Read( tag );
+  if ( tag == 0 ) {
+    r = NULL;
+    return;
+  }
+  Read( index );
+  if ( tag == 1 ) {
+    if ( ( index < 0 ) || ( index >= (int)_replies.size( ) ) ) {
+      _Fail( "corrupt reply reference" );
+    }
+    r = _replies[index];
+    return;
+  }
+  if ( index != (int)_replies.size( ) ) {
+    _Fail( "corrupt reply" );
+  }
+  r = PacketReplyInfo::New( );
+  _replies.push_back( r );
+  int type;
+  Read( r->source );
+  Read( r->time );
+  Read( r->record );
+  Read( type );
+  r->type = (Flit::FlitType)type;
+}
@@ -0,0 +1,267 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*checkpoint.hpp
+ *
+ *Binary snapshot streams for saving and restoring the simulator state.
+ *Flits, credits and reply records are written in full the first time they
+ *are seen and as references afterwards, so objects that are reachable from
+ *several places (e.g. a flit that sits in a router buffer and in the
+ *traffic manager's in-flight map) are restored as one shared object
+ *
+ */
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <queue>
+#include <map>
+#include <set>
+
+#include "flit.hpp"
+#include "credit.hpp"
+#include "outputset.hpp"
+
+class PacketReplyInfo;
+
+class CheckpointWriter {
+
+  ostream & _os;
+
+  map<Flit const *, int> _flits;
+  map<Credit const *, int> _credits;
+  map<PacketReplyInfo const *, int> _replies;
+
+  template<typename T>
+  inline void _Raw( T const & v ) {
+    _os.write( reinterpret_cast<char const *>( &v ), sizeof( T ) );
+  }
+
+public:
+
+  CheckpointWriter( ostream & os );
+
+  // named marker, checked on restore to catch mismatched snapshots
+  void Section( string const & name );
+
+  void Write( bool v ) { _Raw( v ); }
+  void Write( int v ) { _Raw( v ); }
+  void Write( long v ) { _Raw( v ); }
+  void Write( unsigned long long v ) { _Raw( v ); }
+  void Write( double v ) { _Raw( v ); }
+  void Write( string const & s );
+  void Write( OutputSet const & s );
+  void Write( Flit const * f );
+  void Write( Credit const * c );
+  void Write( PacketReplyInfo const * r );
+
+  template<typename A, typename B>
+  void Write( pair<A, B> const & p ) {
+    Write( p.first );
+    Write( p.second );
+  }
+  template<typename T>
+  void Write( vector<T> const & v ) {
+    Write( (int)v.size( ) );
+    for ( typename vector<T>::const_iterator i = v.begin( ); i != v.end( ); ++i ) {
+      Write( *i );
+    }
+  }
+  template<typename T>
+  void Write( deque<T> const & d ) {
+    Write( (int)d.size( ) );
+    for ( typename deque<T>::const_iterator i = d.begin( ); i != d.end( ); ++i ) {
+      Write( *i );
+    }
+  }
+  template<typename T>
+  void Write( list<T> const & l ) {
+    Write( (int)l.size( ) );
+    for ( typename list<T>::const_iterator i = l.begin( ); i != l.end( ); ++i ) {
+      Write( *i );
+    }
+  }
+  template<typename T>
+  void Write( queue<T> q ) {
+    Write( (int)q.size( ) );
+    for ( ; !q.empty( ); q.pop( ) ) {
+      Write( q.front( ) );
+    }
+  }
+  template<typename T>
+  void Write( set<T> const & s ) {
+    Write( (int)s.size( ) );
+    for ( typename set<T>::const_iterator i = s.begin( ); i != s.end( ); ++i ) {
+      Write( *i );
+    }
+  }
+  template<typename K, typename V>
+  void Write( map<K, V> const & m ) {
+    Write( (int)m.size( ) );
+    for ( typename map<K, V>::const_iterator i = m.begin( ); i != m.end( ); ++i ) {
+      Write( *i );
+    }
+  }
+  template<typename K, typename V>
+  void Write( multimap<K, V> const & m ) {
+    Write( (int)m.size( ) );
+    for ( typename multimap<K, V>::const_iterator i = m.begin( ); i != m.end( ); ++i ) {
+      Write( *i );
+    }
+  }
+};
+
+class CheckpointReader {
+
+  istream & _is;
+
+  vector<Flit *> _flits;
+  vector<Credit *> _credits;
+  vector<PacketReplyInfo *> _replies;
+
+  template<typename T>
+  inline void _Raw( T & v ) {
+    _is.read( reinterpret_cast<char *>( &v ), sizeof( T ) );
+    if ( !_is ) {
+      _Fail( "unexpected end of checkpoint" );
+    }
+  }
+  void _Fail( string const & msg ) const;
+
+public:
+
+  CheckpointReader( istream & is );
+
+  void Section( string const & name );
+  // abort unless the restored value equals the one of this simulator
+  void Expect( int v, string const & what );
+
+  void Read( bool & v ) { _Raw( v ); }
+  void Read( int & v ) { _Raw( v ); }
+  void Read( long & v ) { _Raw( v ); }
+  void Read( unsigned long long & v ) { _Raw( v ); }
+  void Read( double & v ) { _Raw( v ); }
+  void Read( string & s );
+  void Read( OutputSet & s );
+  void Read( Flit * & f );
+  void Read( Credit * & c );
+  void Read( PacketReplyInfo * & r );
+
+  // every flit created by this reader
+  inline vector<Flit *> const & Flits( ) const { return _flits; }
+
+  template<typename A, typename B>
+  void Read( pair<A, B> & p ) {
+    Read( p.first );
+    Read( p.second );
+  }
+  template<typename T>
+  void Read( vector<T> & v ) {
+    int size;
+    Read( size );
+    v.resize( size );
+    for ( int i = 0; i < size; ++i ) {
+      T e;
+      Read( e );
+      v[i] = e;
+    }
+  }
+  template<typename T>
+  void Read( deque<T> & d ) {
+    int size;
+    Read( size );
+    d.clear( );
+    for ( int i = 0; i < size; ++i ) {
+      T e;
+      Read( e );
+      d.push_back( e );
+    }
+  }
+  template<typename T>
+  void Read( list<T> & l ) {
+    int size;
+    Read( size );
+    l.clear( );
+    for ( int i = 0; i < size; ++i ) {
+      T e;
+      Read( e );
+      l.push_back( e );
+    }
+  }
+  template<typename T>
+  void Read( queue<T> & q ) {
+    int size;
+    Read( size );
+    q = queue<T>( );
+    for ( int i = 0; i < size; ++i ) {
+      T e;
+      Read( e );
+      q.push( e );
+    }
+  }
+  template<typename T>
+  void Read( set<T> & s ) {
+    int size;
+    Read( size );
+    s.clear( );
+    for ( int i = 0; i < size; ++i ) {
+      T e;
+      Read( e );
+      s.insert( e );
+    }
+  }
+  template<typename K, typename V>
+  void Read( map<K, V> & m ) {
+    int size;
+    Read( size );
+    m.clear( );
+    for ( int i = 0; i < size; ++i ) {
+      pair<K, V> e;
+      Read( e );
+      m.insert( e );
+    }
+  }
+  template<typename K, typename V>
+  void Read( multimap<K, V> & m ) {
+    int size;
+    Read( size );
+    m.clear( );
+    for ( int i = 0; i < size; ++i ) {
+      pair<K, V> e;
+      Read( e );
+      m.insert( m.end( ), e );
+    }
+  }
+};
+
+#endif
@@ -33,47 +33,74 @@
 #include "booksim.hpp"
 #include "credit.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+thread_local Credit::Pool * Credit::_pool = NULL;
 
 Credit::Credit()
+  : _vc_mask(0)
 {
+  for(int vc = 0; vc < MAX_VCS; ++vc) {
+    _vc_count[vc] = 0;
+  }
   Reset();
 }
 
 void Credit::Reset()
 {
-  vc.clear();
+  for(int vc = FirstVC(); vc >= 0; vc = NextVC(vc)) {
+    _vc_count[vc] = 0;
+  }
+  _vc_mask = 0;
   head = false;
   tail = false;
   id   = -1;
 }
 
 Credit * Credit::New() {
+  assert(_pool);
+  unique_lock<mutex> guard(_pool->lock, defer_lock);
+  if(_pool->thread_safe) {
+    guard.lock();
+  }
   Credit * c;
-  if(_free.empty()) {
+  if(_pool->free.empty()) {
     c = new Credit();
-    _all.push(c);
+    _pool->all.push_back(c);
   } else {
-    c = _free.top();
+    c = _pool->free.back();
     c->Reset();
-    _free.pop();
+    _pool->free.pop_back();
   }
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  unique_lock<mutex> guard(_pool->lock, defer_lock);
+  if(_pool->thread_safe) {
+    guard.lock();
+  }
+  _pool->free.push_back(this);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  _pool->Release();
+}
+
+void Credit::Pool::Release() {
+  for(size_t i = 0; i < all.size(); ++i) {
+    delete all[i];
   }
+  all.clear();
+  free.clear();
+}
+
+void Credit::SetPool(Pool * pool) {
+  _pool = pool;
 }
 
+void Credit::SetThreadSafe(bool thread_safe) {
+  _pool->thread_safe = thread_safe;
+}
 
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  return _pool->all.size()-_pool->free.size();
 }
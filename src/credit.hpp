@@ -28,31 +28,77 @@
 #ifndef _CREDIT_HPP_
 #define _CREDIT_HPP_
 
-#include <set>
-#include <stack>
+#include <cassert>
+#include <climits>
+#include <vector>
+#include <mutex>
 
 class Credit {
 
 public:
-  // 하나의 channel에 존재하는 모든 vc들에 해당하는 credit을 한번에 보냄
-  // 한 vc에서 여러 buffer가 자리가 생겼을 때는
-  // map으로 정확히 available해진 buffer 수를 나타내야할듯?!
-  set<int> vc;
+  // a credit returns buffer slots for any subset of a channel's VCs at once;
+  // slots freed on the same VC in one cycle are coalesced into a count
+  static const int MAX_VCS = 64;
 
   // these are only used by the event router
   bool head, tail;
   int  id;
 
   void Reset();
+
+  inline void AddVC( int vc ) {
+    assert( ( vc >= 0 ) && ( vc < MAX_VCS ) );
+    _vc_mask |= ( 1ULL << vc );
+    assert( _vc_count[vc] < USHRT_MAX );
+    ++_vc_count[vc];
+  }
+  inline bool Empty( ) const {
+    return _vc_mask == 0;
+  }
+  inline int NumVCs( ) const {
+    return __builtin_popcountll( _vc_mask );
+  }
+  // number of slots returned for a VC
+  inline int Count( int vc ) const {
+    return _vc_count[vc];
+  }
+
+  // iterate over the VCs in increasing order; -1 marks the end
+  inline int FirstVC( ) const {
+    return _vc_mask ? __builtin_ctzll( _vc_mask ) : -1;
+  }
+  inline int NextVC( int vc ) const {
+    unsigned long long const rest = _vc_mask & ~( ( 2ULL << vc ) - 1 );
+    return rest ? __builtin_ctzll( rest ) : -1;
+  }
   
   static Credit * New();
   void Free();
   static void FreeAll();
   static int OutStanding();
+
+  // serialize pool accesses once routers are stepped by several threads
+  static void SetThreadSafe(bool thread_safe);
+
+  // credit storage of one simulation; owned by its SimContext
+  struct Pool {
+    vector<Credit *> all;
+    vector<Credit *> free;
+    bool thread_safe;
+    mutex lock;
+    Pool() : thread_safe(false) {}
+    ~Pool() { Release(); }
+    void Release();
+  };
+  static void SetPool(Pool * pool);
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  unsigned long long _vc_mask;
+  // wide enough for every slot of a deep VC buffer, since credits held
+  // back for several cycles are merged into one
+  unsigned short _vc_count[MAX_VCS];
+
+  static thread_local Pool * _pool;
 
   Credit();
   ~Credit() {}
@@ -34,11 +34,12 @@
  *When adding objects make sure to set a default value in this constructor
  */
 
+#include <cassert>
+
 #include "booksim.hpp"
 #include "flit.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+thread_local Flit::Pool * Flit::_pool = NULL;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -80,28 +81,65 @@ void Flit::Reset()
   intm =-1;
   ph = -1;
   data = 0;
+  mcast.clear();
 }  
 
 Flit * Flit::New() {
-  Flit * f;
-  if(_free.empty()) {
-    f = new Flit;
-    _all.push(f);
-  } else {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
+  assert(_pool);
+  unique_lock<mutex> guard(_pool->lock, defer_lock);
+  if(_pool->thread_safe) {
+    guard.lock();
+  }
+  vector<Flit *> & free = _pool->free;
+  if(free.empty()) {
+    Flit * const slab = new Flit[_slab_size];
+    _pool->slabs.push_back(slab);
+    free.reserve(_pool->slabs.size() * _slab_size);
+    // hand out the slab front to back
+    for(int i = _slab_size - 1; i >= 0; --i) {
+      free.push_back(&slab[i]);
+    }
+  }
+  Flit * const f = free.back();
+  free.pop_back();
+  f->Reset();
+  if(++_pool->live > _pool->peak_live) {
+    _pool->peak_live = _pool->live;
   }
   return f;
 }
 
 void Flit::Free() {
-  _free.push(this);
+  unique_lock<mutex> guard(_pool->lock, defer_lock);
+  if(_pool->thread_safe) {
+    guard.lock();
+  }
+  --_pool->live;
+  _pool->free.push_back(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  _pool->Release();
+}
+
+void Flit::Pool::Release() {
+  for(size_t s = 0; s < slabs.size(); ++s) {
+    delete [] slabs[s];
   }
+  slabs.clear();
+  free.clear();
+  live = 0;
+}
+
+void Flit::SetPool( Pool * pool ) {
+  _pool = pool;
+}
+
+void Flit::SetThreadSafe( bool thread_safe ) {
+  _pool->thread_safe = thread_safe;
+}
+
+void Flit::DisplayStats( ostream & os ) {
+  os << "Flit pool: " << _pool->slabs.size() << " slabs of " << _slab_size
+     << " flits, peak of " << _pool->peak_live << " live flits" << endl;
 }
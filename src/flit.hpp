@@ -29,12 +29,17 @@
 #define _FLIT_HPP_
 
 #include <iostream>
-#include <stack>
+#include <vector>
+#include <mutex>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
 
-class Flit {
+// flits are carved out of contiguous slabs; the fields touched by routing,
+// allocation and buffer management come first so that they share the first
+// cache line, followed by the timestamps and debug fields only read on
+// injection, retirement and for tracing
+class alignas(64) Flit {
 
 public:
 
@@ -44,58 +49,89 @@ public:
 		  WRITE_REQUEST = 2,
 		  WRITE_REPLY   = 3,
                   ANY_TYPE      = 4 };
-  FlitType type;
+
+  // ==== hot: routing and allocation ====
 
   int vc;
 
   int cl;
 
-  bool head;
-  bool tail;
-  
-  int  ctime;
-  int  itime;
-  int  atime;
-
-  int  id;
-  int  pid;
-
-  bool record;
-
   int  src;
   int  dest;
 
   int  pri;
 
-  int  hops;
-  bool watch;
-  int  subnetwork;
-  
   // intermediate destination (if any)
   mutable int intm;
 
   // phase in multi-phase algorithms
   mutable int ph;
 
-  // Fields for arbitrary data
-  void* data ;
+  int  subnetwork;
+
+  FlitType type;
+
+  int  hops;
+
+  int  id;
+  int  pid;
+
+  bool head;
+  bool tail;
+  bool watch;
+  bool record;
 
   // Lookahead route info
   OutputSet la_route_set;
 
+  // ==== cold: timestamps and tracing ====
+
+  int  ctime;
+  int  itime;
+  int  atime;
+
+  // Fields for arbitrary data
+  void* data ;
+
+  // destinations of a multicast packet in increasing order, dest being the
+  // first; routers narrow the set of a head to the destinations of its
+  // branch, body flits keep the full set
+  vector<int> mcast;
+
   void Reset();
 
   static Flit * New();
   void Free();
   static void FreeAll();
 
+  // allocator usage (peak live flits, slabs) for the end of a run
+  static void DisplayStats( ostream & os = cout );
+
+  // serialize pool accesses once routers are stepped by several threads
+  static void SetThreadSafe( bool thread_safe );
+
+  // flit storage of one simulation; owned by its SimContext
+  struct Pool {
+    vector<Flit *> slabs;
+    vector<Flit *> free;
+    int live;
+    int peak_live;
+    bool thread_safe;
+    mutex lock;
+    Pool() : live(0), peak_live(0), thread_safe(false) {}
+    ~Pool() { Release(); }
+    void Release();
+  };
+  static void SetPool( Pool * pool );
+
 private:
 
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  static const int _slab_size = 1024;
+
+  static thread_local Pool * _pool;
 
 };
 
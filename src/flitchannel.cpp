@@ -85,8 +85,8 @@ void FlitChannel::ReadInputs() {
 
 void FlitChannel::WriteOutputs() {
   Channel<Flit>::WriteOutputs();
-  for (size_t i = 0; i < _output.size(); ++i) {
-    Flit const * const & f = _output[i];
+  for (int i = 0; i < _OutputSize(); ++i) {
+    Flit const * const f = _Output(i);
     if(f && f->watch) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
           << "Completed channel traversal for flit " << f->id
@@ -94,3 +94,15 @@ void FlitChannel::WriteOutputs() {
     }
   }
 }
+
+void FlitChannel::Save(CheckpointWriter & w) const {
+  Channel<Flit>::Save(w);
+  w.Write(_active);
+  w.Write(_idle);
+}
+
+void FlitChannel::Load(CheckpointReader & r) {
+  Channel<Flit>::Load(r);
+  r.Read(_active);
+  r.Read(_idle);
+}
@@ -78,6 +78,9 @@ public:
   virtual void ReadInputs();
   virtual void WriteOutputs();
 
+  virtual void Save(CheckpointWriter & w) const;
+  virtual void Load(CheckpointReader & r);
+
 private:
   
   ////////////////////////////////////////
@@ -31,23 +31,28 @@
 #include <vector>
 #include <iostream>
 
-/*all declared in main.cpp*/
+/*all declared in main.cpp; each simulation thread has its own copy*/
 
 int GetSimTime();
 
+class BookSimConfig;
+// run one simulation on the calling thread; if csv is given, the overall
+// results are also written to it (see TrafficManager::WriteOverallStatsCSV)
+bool Simulate( BookSimConfig const & config, std::ostream * csv = NULL );
+
 class Stats;
 Stats * GetStats(const std::string & name);
 
-extern bool gPrintActivity;
+extern thread_local bool gPrintActivity;
 
-extern int gK;
-extern int gN;
-extern int gC;
+extern thread_local int gK;
+extern thread_local int gN;
+extern thread_local int gC;
 
-extern int gNodes;
+extern thread_local int gNodes;
 
-extern bool gTrace;
+extern thread_local bool gTrace;
 
-extern std::ostream * gWatchOut;
+extern thread_local std::ostream * gWatchOut;
 
 #endif
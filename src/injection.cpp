@@ -31,6 +31,7 @@
 #include <limits>
 #include "random_utils.hpp"
 #include "injection.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -191,6 +192,22 @@ bool OnOffInjectionProcess::test(int source)
   return _state[source] && (RandomFloat() < _r1);
 }
 
+void OnOffInjectionProcess::Save(CheckpointWriter & writer) const
+{
+  writer.Write(_nodes);
+  for(int n = 0; n < _nodes; ++n) {
+    writer.Write(_state[n]);
+  }
+}
+
+void OnOffInjectionProcess::Load(CheckpointReader & reader)
+{
+  reader.Expect(_nodes, "injection process size");
+  for(int n = 0; n < _nodes; ++n) {
+    reader.Read(_state[n]);
+  }
+}
+
 //=============================================================
 
 GPUInjectionProcess::GPUInjectionProcess(int nodes, double rate, 
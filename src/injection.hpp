@@ -30,6 +30,9 @@
 
 #include "config_utils.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 using namespace std;
 
 class InjectionProcess {
@@ -41,6 +44,8 @@ public:
   virtual ~InjectionProcess() {}
   virtual bool test(int source) = 0;
   virtual void reset();
+  virtual void Save(CheckpointWriter & writer) const {}
+  virtual void Load(CheckpointReader & reader) {}
   static InjectionProcess * New(string const & inject, int nodes, double load, 
 				Configuration const * const config = NULL);
 };
@@ -63,6 +68,8 @@ public:
 			double r1, vector<int> initial);
   virtual void reset();
   virtual bool test(int source);
+  virtual void Save(CheckpointWriter & writer) const;
+  virtual void Load(CheckpointReader & reader);
 };
 
 
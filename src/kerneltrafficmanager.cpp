@@ -0,0 +1,222 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <limits>
+#include <sstream>
+#include <algorithm>
+
+#include "packet_reply_info.hpp"
+#include "random_utils.hpp"
+#include "kerneltrafficmanager.hpp"
+
+KernelTrafficManager::KernelTrafficManager( const Configuration &config, 
+					    const vector<Network *> & net )
+: TrafficManager(config, net), _overall_min_phase_time(0), 
+  _overall_avg_phase_time(0), _overall_max_phase_time(0)
+{
+  _kernel_requests = config.GetInt( "kernel_requests" );
+  _kernel_count = config.GetInt( "kernel_count" );
+  if((_kernel_requests < 1) || (_kernel_count < 1)) {
+    Error("kernel_requests and kernel_count must be positive.");
+  }
+
+  _nodes_sm = config.GetInt( "sm" );
+  if((_nodes_sm <= 0) || (_nodes_sm > _nodes)) {
+    Error("Kernel mode needs sm SMs among the network's nodes.");
+  }
+  for(int c = 0; c < _classes; ++c) {
+    if(!_use_read_write[c]) {
+      Error("Kernel mode needs use_read_write for every class.");
+    }
+  }
+
+  if(!_checkpoint_out.empty() || !_checkpoint_in.empty()) {
+    Error("Checkpoints are not supported in kernel mode.");
+  }
+  if(_trace) {
+    Error("Trace replay is not supported in kernel mode.");
+  }
+
+  _issued.resize(_nodes_sm, 0);
+  _finish_time.resize(_nodes_sm, -1);
+
+  _phase_time = new Stats( this, "kernel_phase_time", 1.0, 1000 );
+  _stats["kernel_phase_time"] = _phase_time;
+  _sm_time = new Stats( this, "kernel_sm_time", 1.0, 1000 );
+  _stats["kernel_sm_time"] = _sm_time;
+}
+
+KernelTrafficManager::~KernelTrafficManager( )
+{
+  delete _phase_time;
+  delete _sm_time;
+}
+
+void KernelTrafficManager::_RetireFlit( Flit *f, int dest )
+{
+  if(f->tail && (dest < _nodes_sm) &&
+     ((f->type == Flit::READ_REPLY) || (f->type == Flit::WRITE_REPLY))) {
+    _finish_time[dest] = _time;
+  }
+  TrafficManager::_RetireFlit(f, dest);
+}
+
+int KernelTrafficManager::_IssuePacket( int source, int cl )
+{
+  int result = 0;
+  //check queue for waiting replies.
+  //check to make sure it is on time yet
+  if(!_repliesPending[source].empty()) {
+    if(_repliesPending[source].front()->time <= _time) {
+      result = -1;
+    }
+  } else if((source < _nodes_sm) && (_issued[source] < _kernel_requests) &&
+	    ((_mshrs <= 0) || (_requestsOutstanding[source] < _mshrs))) {
+    result = (RandomFloat() < _write_fraction[cl]) ? 2 : 1;
+    _requestsOutstanding[source]++;
+    _issued[source]++;
+  }
+  if(result != 0) {
+    _packet_seq_no[source]++;
+  }
+  return result;
+}
+
+void KernelTrafficManager::_ClearStats( )
+{
+  TrafficManager::_ClearStats();
+  _phase_time->Clear( );
+  _sm_time->Clear( );
+}
+
+bool KernelTrafficManager::_PhaseComplete( ) const
+{
+  for(int s = 0; s < _nodes_sm; ++s) {
+    if((_issued[s] < _kernel_requests) || (_requestsOutstanding[s] > 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool KernelTrafficManager::_SingleSim( )
+{
+  for(int phase = 0; phase < _kernel_count; ++phase) {
+    _issued.assign(_nodes_sm, 0);
+    _finish_time.assign(_nodes_sm, -1);
+    _sim_state = running;
+    int const start_time = _time;
+    cout << "Launching kernel phase " << phase + 1 << " (" << _kernel_requests
+	 << " requests per SM)..." << endl;
+
+    int steps = 0;
+    do {
+      _Step();
+      if ( ++steps % 1000 == 0 ) {
+	_DisplayRemaining( ); 
+      }
+    } while(!_PhaseComplete());
+
+    // completion time of every SM, the slowest one holds the barrier
+    vector<int> sm_time(_nodes_sm);
+    int tail_sm = 0;
+    for(int s = 0; s < _nodes_sm; ++s) {
+      sm_time[s] = _finish_time[s] - start_time;
+      _sm_time->AddSample(sm_time[s]);
+      if(sm_time[s] > sm_time[tail_sm]) {
+	tail_sm = s;
+      }
+    }
+    int const phase_time = _time - start_time;
+    _phase_time->AddSample(phase_time);
+
+    vector<int> sorted(sm_time);
+    sort(sorted.begin(), sorted.end());
+    cout << "Kernel phase " << phase + 1 << " completed in " << phase_time
+	 << " cycles." << endl
+	 << "SM completion time median = " << sorted[(_nodes_sm - 1) / 2]
+	 << ", 90th percentile = " << sorted[(_nodes_sm - 1) * 9 / 10]
+	 << ", minimum = " << sorted.front()
+	 << ", maximum = " << sorted.back() << endl
+	 << "Tail SM = " << tail_sm << " (" << sm_time[tail_sm] << " cycles)" << endl;
+
+    UpdateStats();
+    DisplayStats();
+  }
+  _sim_state = draining;
+  _drain_time = _time;
+  return 1;
+}
+
+void KernelTrafficManager::_UpdateOverallStats() {
+  TrafficManager::_UpdateOverallStats();
+  _overall_min_phase_time += _phase_time->Min();
+  _overall_avg_phase_time += _phase_time->Average();
+  _overall_max_phase_time += _phase_time->Max();
+}
+  
+string KernelTrafficManager::_OverallStatsCSV(int c) const
+{
+  ostringstream os;
+  os << TrafficManager::_OverallStatsCSV(c) << ','
+     << _overall_min_phase_time / (double)_total_sims << ','
+     << _overall_avg_phase_time / (double)_total_sims << ','
+     << _overall_max_phase_time / (double)_total_sims;
+  return os.str();
+}
+
+string KernelTrafficManager::_OverallStatsCSVHeader() const
+{
+  return TrafficManager::_OverallStatsCSVHeader() +
+    ",min_phase_time,avg_phase_time,max_phase_time";
+}
+
+void KernelTrafficManager::WriteStats(ostream & os) const
+{
+  TrafficManager::WriteStats(os);
+  os << "kernel_phase_time = " << _phase_time->Average() << ";" << endl
+     << "kernel_sm_time = " << _sm_time->Average() << ";" << endl;
+}    
+
+void KernelTrafficManager::DisplayStats(ostream & os) const {
+  TrafficManager::DisplayStats();
+  os << "Minimum kernel phase duration = " << _phase_time->Min() << endl;
+  os << "Average kernel phase duration = " << _phase_time->Average() << endl;
+  os << "Maximum kernel phase duration = " << _phase_time->Max() << endl;
+  os << "Average SM completion time = " << _sm_time->Average() << endl;
+}
+
+void KernelTrafficManager::DisplayOverallStats(ostream & os) const {
+  TrafficManager::DisplayOverallStats(os);
+  os << "Overall min kernel phase duration = " << _overall_min_phase_time / (double)_total_sims
+     << " (" << _total_sims << " samples)" << endl
+     << "Overall avg kernel phase duration = " << _overall_avg_phase_time / (double)_total_sims
+     << " (" << _total_sims << " samples)" << endl
+     << "Overall max kernel phase duration = " << _overall_max_phase_time / (double)_total_sims
+     << " (" << _total_sims << " samples)" << endl;
+}
@@ -0,0 +1,80 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef _KERNELTRAFFICMANAGER_HPP_
+#define _KERNELTRAFFICMANAGER_HPP_
+
+#include <iostream>
+
+#include "config_utils.hpp"
+#include "stats.hpp"
+#include "trafficmanager.hpp"
+
+// GPU kernel phases: every SM issues _kernel_requests read/write requests
+// and the next phase starts once the last SM has all of its replies
+class KernelTrafficManager : public TrafficManager {
+
+protected:
+
+  int _kernel_requests;
+  int _kernel_count;
+
+  vector<int> _issued;
+  vector<int> _finish_time;
+
+  Stats * _phase_time;
+  Stats * _sm_time;
+  double _overall_min_phase_time;
+  double _overall_avg_phase_time;
+  double _overall_max_phase_time;
+
+  virtual void _RetireFlit( Flit *f, int dest );
+
+  virtual int _IssuePacket( int source, int cl );
+  virtual void _ClearStats( );
+  virtual bool _SingleSim( );
+
+  bool _PhaseComplete( ) const;
+
+  virtual void _UpdateOverallStats( );
+
+  virtual string _OverallStatsCSV(int c = 0) const;
+  virtual string _OverallStatsCSVHeader() const;
+
+public:
+
+  KernelTrafficManager( const Configuration &config, const vector<Network *> & net );
+  virtual ~KernelTrafficManager( );
+
+  virtual void WriteStats( ostream & os = cout ) const;
+  virtual void DisplayStats( ostream & os = cout ) const;
+  virtual void DisplayOverallStats( ostream & os = cout ) const;
+
+};
+
+#endif
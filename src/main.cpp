@@ -53,6 +53,8 @@
 #include "network.hpp"
 #include "injection.hpp"
 #include "power_module.hpp"
+#include "sim_context.hpp"
+#include "sweep.hpp"
 
 
 
@@ -61,7 +63,7 @@
 //////////////////////
 
  /* the current traffic manager instance */
-TrafficManager * trafficManager = NULL;
+thread_local TrafficManager * trafficManager = NULL;
 
 int GetSimTime() {
   return trafficManager->getTime();
@@ -77,25 +79,47 @@ Stats * GetStats(const std::string & name) {
 }
 
 /* printing activity factor*/
-bool gPrintActivity;
+thread_local bool gPrintActivity;
 
-int gK;//radix
-int gN;//dimension
-int gC;//concentration
+thread_local int gK;//radix
+thread_local int gN;//dimension
+thread_local int gC;//concentration
 
-int gNodes;
+thread_local int gNodes;
 
 //generate nocviewer trace
-bool gTrace;
+thread_local bool gTrace;
 
-ostream * gWatchOut;
+thread_local ostream * gWatchOut;
 
 
 
 /////////////////////////////////////////////////////////////////////////////
 
-bool Simulate( BookSimConfig const & config )
+bool Simulate( BookSimConfig const & config, ostream * csv )
 {
+  /* pools and globals of this run live in (or are bound through) the
+   * context, so simulations on different threads do not interfere
+   */
+  SimContext context;
+  context.Bind();
+
+  /*initialize routing, traffic, injection functions
+   */
+  InitializeRoutingMap( config );
+
+  gPrintActivity = (config.GetInt("print_activity") > 0);
+  gTrace = (config.GetInt("viewer_trace") > 0);
+  
+  string watch_out_file = config.GetStr( "watch_out" );
+  if(watch_out_file == "") {
+    gWatchOut = NULL;
+  } else if(watch_out_file == "-") {
+    gWatchOut = &cout;
+  } else {
+    gWatchOut = new ofstream(watch_out_file.c_str());
+  }
+
   vector<Network *> net;
 
   int subnets = config.GetInt("subnets");
@@ -132,6 +156,13 @@ bool Simulate( BookSimConfig const & config )
             - ((double)(start_time.tv_sec) + (double)(start_time.tv_usec)/1000000.0);
 
   cout<<"Total run time "<<total_time<<endl;
+  if(config.GetInt("profile") > 0) {
+    Flit::DisplayStats();
+  }
+
+  if(result && csv) {
+    trafficManager->WriteOverallStatsCSV(*csv);
+  }
 
   for (int i=0; i<subnets; ++i) {
 
@@ -163,25 +194,8 @@ int main( int argc, char **argv )
  } 
 
   
-  /*initialize routing, traffic, injection functions
-   */
-  InitializeRoutingMap( config );
-
-  gPrintActivity = (config.GetInt("print_activity") > 0);
-  gTrace = (config.GetInt("viewer_trace") > 0);
-  
-  string watch_out_file = config.GetStr( "watch_out" );
-  if(watch_out_file == "") {
-    gWatchOut = NULL;
-  } else if(watch_out_file == "-") {
-    gWatchOut = &cout;
-  } else {
-    gWatchOut = new ofstream(watch_out_file.c_str());
-  }
-  
-
   /*configure and run the simulator
    */
-  bool result = Simulate( config );
+  bool result = IsSweep( config ) ? Sweep( config ) : Simulate( config );
   return result ? -1 : 0;
 }
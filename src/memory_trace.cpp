@@ -0,0 +1,247 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "memory_trace.hpp"
+#include "checkpoint.hpp"
+
+namespace {
+  char const trace_magic[8] = { 'B', 'S', 'T', 'R', 'A', 'C', 'E', '1' };
+  size_t const header_bytes = 16;
+  size_t const record_bytes = 24;
+  // consumed part of the mapping is handed back in chunks of this size
+  size_t const release_bytes = 64 << 20;
+}
+
+MemoryTrace::MemoryTrace( string const & filename, int sms, int lookahead,
+                          int max_pending )
+  : _filename( filename ), _fd( -1 ), _data( NULL ), _length( 0 ),
+    _records( 0 ), _lookahead( lookahead ), _max_pending( max_pending )
+{
+  if ( ( lookahead < 0 ) || ( max_pending <= 0 ) ) {
+    cout << "Error: Trace lookahead must be non-negative and its buffer positive." << endl;
+    exit(-1);
+  }
+
+  _fd = open( filename.c_str( ), O_RDONLY );
+  struct stat st;
+  if ( ( _fd < 0 ) || ( fstat( _fd, &st ) != 0 ) ) {
+    cout << "Error: Cannot open trace file " << filename << endl;
+    exit(-1);
+  }
+  _length = st.st_size;
+  if ( _length < header_bytes ) {
+    cout << "Error: Trace file " << filename << " has no header." << endl;
+    exit(-1);
+  }
+
+  void * p = mmap( NULL, _length, PROT_READ, MAP_PRIVATE, _fd, 0 );
+  if ( p == MAP_FAILED ) {
+    cout << "Error: Cannot map trace file " << filename << endl;
+    exit(-1);
+  }
+  _data = static_cast<unsigned char const *>( p );
+  madvise( p, _length, MADV_SEQUENTIAL );
+
+  unsigned int size;
+  memcpy( &size, _data + 8, sizeof( size ) );
+  if ( memcmp( _data, trace_magic, sizeof( trace_magic ) ) ||
+       ( size != record_bytes ) ) {
+    cout << "Error: " << filename << " is not a memory trace." << endl;
+    exit(-1);
+  }
+  if ( ( _length - header_bytes ) % record_bytes ) {
+    cout << "Error: Trace file " << filename << " ends in a partial record." << endl;
+    exit(-1);
+  }
+  _records = ( _length - header_bytes ) / record_bytes;
+
+  _queues.resize( sms );
+  Reset( );
+}
+
+MemoryTrace::~MemoryTrace( )
+{
+  munmap( const_cast<unsigned char *>( _data ), _length );
+  close( _fd );
+}
+
+void MemoryTrace::Reset( )
+{
+  _cursor = 0;
+  _last_cycle = 0;
+  _released = 0;
+  _pending = 0;
+  for ( size_t s = 0; s < _queues.size( ); ++s ) {
+    _queues[s].clear( );
+  }
+}
+
+void MemoryTrace::_Decode( unsigned long long index, Record & r ) const
+{
+  assert( index < _records );
+  unsigned char const * p = _data + header_bytes + index * record_bytes;
+  unsigned int sm;
+  unsigned short size;
+  memcpy( &r.cycle, p, 8 );
+  memcpy( &r.addr, p + 8, 8 );
+  memcpy( &sm, p + 16, 4 );
+  memcpy( &size, p + 20, 2 );
+  r.sm = (int)sm;
+  r.size = size;
+  r.write = ( p[22] & 1 ) != 0;
+}
+
+void MemoryTrace::_Release( )
+{
+  size_t const consumed = header_bytes + _cursor * record_bytes;
+  if ( consumed - _released < release_bytes ) {
+    return;
+  }
+  size_t const page = sysconf( _SC_PAGESIZE );
+  size_t const end = consumed - consumed % page;
+  madvise( const_cast<unsigned char *>( _data ) + _released, end - _released,
+           MADV_DONTNEED );
+  _released = end;
+}
+
+void MemoryTrace::Fill( int time )
+{
+  unsigned long long const horizon = (unsigned long long)time + _lookahead;
+  bool advanced = false;
+  while ( ( _cursor < _records ) && ( _pending < _max_pending ) ) {
+    Record r;
+    _Decode( _cursor, r );
+    if ( r.cycle > horizon ) {
+      break;
+    }
+    if ( r.cycle < _last_cycle ) {
+      cout << "Error: Trace record " << _cursor << " of " << _filename
+           << " goes back in time." << endl;
+      exit(-1);
+    }
+    if ( ( r.sm < 0 ) || ( r.sm >= (int)_queues.size( ) ) ) {
+      cout << "Error: Trace record " << _cursor << " of " << _filename
+           << " names SM " << r.sm << " of " << _queues.size( ) << "." << endl;
+      exit(-1);
+    }
+    _last_cycle = r.cycle;
+    _queues[r.sm].push_back( r );
+    ++_pending;
+    ++_cursor;
+    advanced = true;
+  }
+  if ( advanced ) {
+    _Release( );
+  }
+}
+
+bool MemoryTrace::Next( int sm, int time, Record & r )
+{
+  deque<Record> & q = _queues[sm];
+  if ( q.empty( ) || ( q.front( ).cycle > (unsigned long long)time ) ) {
+    return false;
+  }
+  r = q.front( );
+  q.pop_front( );
+  --_pending;
+  return true;
+}
+
+long long MemoryTrace::NextCycle( int sm ) const
+{
+  deque<Record> const & q = _queues[sm];
+  if ( !q.empty( ) ) {
+    return q.front( ).cycle;
+  }
+  if ( _cursor < _records ) {
+    // nothing of this SM decoded yet, so it cannot issue before the
+    // first record that is still in the file
+    Record r;
+    _Decode( _cursor, r );
+    return r.cycle;
+  }
+  return -1;
+}
+
+void MemoryTrace::Save( CheckpointWriter & writer ) const
+{
+  writer.Write( _records );
+  writer.Write( _cursor );
+  writer.Write( _last_cycle );
+  writer.Write( (int)_queues.size( ) );
+  for ( size_t s = 0; s < _queues.size( ); ++s ) {
+    deque<Record> const & q = _queues[s];
+    writer.Write( (int)q.size( ) );
+    for ( deque<Record>::const_iterator i = q.begin( ); i != q.end( ); ++i ) {
+      writer.Write( i->cycle );
+      writer.Write( i->addr );
+      writer.Write( i->sm );
+      writer.Write( i->size );
+      writer.Write( i->write );
+    }
+  }
+}
+
+void MemoryTrace::Load( CheckpointReader & reader )
+{
+  unsigned long long records;
+  reader.Read( records );
+  if ( records != _records ) {
+    cout << "Error: Checkpoint was written for a different trace than "
+         << _filename << endl;
+    exit(-1);
+  }
+  Reset( );
+  reader.Read( _cursor );
+  reader.Read( _last_cycle );
+  reader.Expect( (int)_queues.size( ), "trace SMs" );
+  for ( size_t s = 0; s < _queues.size( ); ++s ) {
+    int size;
+    reader.Read( size );
+    for ( int i = 0; i < size; ++i ) {
+      Record r;
+      reader.Read( r.cycle );
+      reader.Read( r.addr );
+      reader.Read( r.sm );
+      reader.Read( r.size );
+      reader.Read( r.write );
+      _queues[s].push_back( r );
+    }
+    _pending += size;
+  }
+}
@@ -0,0 +1,118 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+/*memory_trace.hpp
+ *
+ *Replays a binary memory trace without reading it into memory. The file is
+ *mapped read-only and decoded front to back; records up to a lookahead
+ *window past the current cycle are moved into per-SM queues, and the pages
+ *behind the read position are released as the replay advances.
+ *
+ *Layout (little endian): a 16-byte header holding the magic "BSTRACE1", the
+ *record size (uint32, 24) and a reserved word, then one record per access:
+ *
+ *  uint64 cycle   issue cycle, non-decreasing over the file
+ *  uint64 addr    byte address
+ *  uint32 sm      issuing SM
+ *  uint16 size    access size in bytes
+ *  uint8  flags   bit 0: write
+ *  uint8  pad
+ *
+ */
+
+#ifndef _MEMORY_TRACE_HPP_
+#define _MEMORY_TRACE_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+
+class CheckpointWriter;
+class CheckpointReader;
+
+using namespace std;
+
+class MemoryTrace {
+
+public:
+
+  struct Record {
+    unsigned long long cycle;
+    unsigned long long addr;
+    int sm;
+    int size;
+    bool write;
+  };
+
+private:
+
+  string _filename;
+  int _fd;
+  unsigned char const * _data;
+  size_t _length;
+
+  unsigned long long _records;
+  unsigned long long _cursor;   // next record to decode
+  unsigned long long _last_cycle;
+  size_t _released;             // bytes of the mapping given back so far
+
+  int _lookahead;
+  int _max_pending;
+  int _pending;
+  vector<deque<Record> > _queues;
+
+  void _Decode( unsigned long long index, Record & r ) const;
+  void _Release( );
+
+public:
+
+  MemoryTrace( string const & filename, int sms, int lookahead, int max_pending );
+  ~MemoryTrace( );
+
+  // rewind to the first record
+  void Reset( );
+
+  // decode records issued no later than time + lookahead
+  void Fill( int time );
+
+  // pop the next record of sm if it is due by time
+  bool Next( int sm, int time, Record & r );
+
+  // earliest cycle at which sm may issue again, -1 once its records are
+  // exhausted
+  long long NextCycle( int sm ) const;
+
+  inline unsigned long long Records( ) const { return _records; }
+
+  void Save( CheckpointWriter & writer ) const;
+  void Load( CheckpointReader & reader );
+};
+
+#endif
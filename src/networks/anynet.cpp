@@ -55,12 +55,14 @@
 #include <sstream>
 #include <limits>
 #include <algorithm>
+#include <set>
 //this is a hack, I can't easily get the routing talbe out of the network
-map<int, int>* global_routing_table;
+thread_local map<int, int>* global_routing_table;
 
 AnyNet::AnyNet( const Configuration &config, const string & name )
   :  Network( config, name ){
 
+  _RequireSerial( );
   router_list.resize(2);
   _ComputeSize( config );
   _Alloc( );
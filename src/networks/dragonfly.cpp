@@ -37,7 +37,7 @@
 
 #define DRAGON_LATENCY
 
-int gP, gA, gG;
+thread_local int gP, gA, gG;
 
 //calculate the hop count between src and estination
 int dragonflynew_hopcnt(int src, int dest) 
@@ -150,6 +150,7 @@ DragonFlyNew::DragonFlyNew( const Configuration &config, const string & name ) :
   Network( config, name )
 {
 
+  _RequireSerial( );
   _ComputeSize( config );
   _Alloc( );
   _BuildNet( config );
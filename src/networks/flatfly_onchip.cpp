@@ -60,15 +60,16 @@
 
 //#define DEBUG_FLATFLY
 
-static int _xcount;
-static int _ycount;
-static int _xrouter;
-static int _yrouter;
+static thread_local int _xcount;
+static thread_local int _ycount;
+static thread_local int _xrouter;
+static thread_local int _yrouter;
 
 FlatFlyOnChip::FlatFlyOnChip( const Configuration &config, const string & name ) :
   Network( config, name )
 {
 
+  _RequireSerial( );
   _ComputeSize( config );
   _Alloc( );
   _BuildNet( config );
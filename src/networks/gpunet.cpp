@@ -2,13 +2,20 @@
 #include <vector>
 #include <sstream>
 #include <cmath>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 
 #include "gpunet.hpp"
 #include "misc_utils.hpp"
 #include "globals.hpp"
 
-int gX; // # of partition crossbars
-vector<int> gU; // units per layer
+thread_local int gX; // # of partition crossbars
+thread_local vector<int> gU; // units per layer
+thread_local int const * gGPUNetRoutes = NULL;
+thread_local int const * gGPUNetPartitionPorts = NULL;
+thread_local int gGPUNetAdaptiveThreshold;
 
 GPUNet::GPUNet( const Configuration& config, const string & name )
 : Network ( config, name )
@@ -23,10 +30,21 @@ void GPUNet::_ComputeSize( const Configuration& config )
   // Number of layers
   _l = config.GetInt("l");
   _partition = (config.GetInt("partition") == 1);
+
+  // Dies, each a full hierarchy with its share of the SMs and L2 slices
+  _dies = config.GetInt("dies");
+  if (_dies < 1) {
+    Error("dies must be positive");
+  }
   
   // Nodes (SM and L2 slices)
   _nodes_sm = config.GetInt("sm");
   _nodes_l2slice = config.GetInt("l2slice");
+  if ((_nodes_sm % _dies) || (_nodes_l2slice % _dies)) {
+    Error("SMs and L2 slices must be divisible by the number of dies");
+  }
+  _sm_die = _nodes_sm / _dies;
+  _l2slice_die = _nodes_l2slice / _dies;
   
   _nodes = _nodes_sm + _nodes_l2slice;
 
@@ -38,7 +56,7 @@ void GPUNet::_ComputeSize( const Configuration& config )
   _total_units.resize(_l);
   for (int l = 0; l < _l; ++l) {
     if (l == 0)
-      _total_units[l] = _nodes_sm / _ratio[l];
+      _total_units[l] = _sm_die / _ratio[l];
     else
       _total_units[l] = _total_units[l - 1] / _ratio[l];
   }
@@ -49,24 +67,28 @@ void GPUNet::_ComputeSize( const Configuration& config )
   }
 
   // Routers for SM-to-L2 Request and Reply Network
-  _size = 0;
+  _die_routers = 0;
   for (int l = 0; l < _l; l++) {
-    _size += 2 * _total_units[l];
+    _die_routers += _total_units[l];
   }
+  _size = 2 * _dies * _die_routers;
 
-  // Channels for SM-to-L2 Network
-  _channels = 0;
+  // Channels for SM-to-L2 Network, per direction
+  _die_channels = 0;
   for (int l = 0; l < _l; l++) {
     if (l < _l - 1) {
-      _channels += 2 * _total_units[l];
+      _die_channels += _total_units[l];
     } else {
       // Fully-connected partitioned crossbars
       _p = _partition ? _total_units[l] : 1;
-      _channels += 2 * _p * (_p - 1);
+      _die_channels += _p * (_p - 1);
     }
   }
+  // Each crossbar is also linked to the same partition's crossbar on
+  // every other die
+  _channels = 2 * (_dies * _die_channels + _dies * (_dies - 1) * _p);
 
-  _l2slice_p = _nodes_l2slice / _p; // L2 slices per partition
+  _l2slice_p = _l2slice_die / _p; // L2 slices per partition
 
   _speedups = config.GetIntArray("speedups");
   if (_speedups.empty() || (_speedups.size() < size_t(_l + 1))) {
@@ -75,9 +97,41 @@ void GPUNet::_ComputeSize( const Configuration& config )
 
   _inter_partition_speedup = config.GetInt("inter_partition_speedup");
 
+  // link widths in bytes per cycle carry that many flits of flit_width
+  int const flit_width = config.GetInt("flit_width");
+  vector<int> widths = config.GetIntArray("layer_widths");
+  int const inter_width = config.GetInt("inter_partition_width");
+  if ((flit_width <= 0) && (!widths.empty() || (inter_width > 0))) {
+    Error("layer_widths and inter_partition_width need flit_width");
+  }
+  if (!widths.empty()) {
+    widths.resize(_l + 1, widths.back());
+    for (int l = 0; l <= _l; ++l) {
+      if ((widths[l] < flit_width) || (widths[l] % flit_width)) {
+        Error("layer_widths must be multiples of flit_width");
+      }
+      _speedups[l] = widths[l] / flit_width;
+    }
+  }
+  if (inter_width > 0) {
+    if ((inter_width < flit_width) || (inter_width % flit_width)) {
+      Error("inter_partition_width must be a multiple of flit_width");
+    }
+    _inter_partition_speedup = inter_width / flit_width;
+  }
+
+  _die_latency = config.GetInt("die_latency");
+  _die_bandwidth = config.GetInt("die_bandwidth");
+  if ((_die_latency < 1) || (_die_bandwidth < 1)) {
+    Error("die_latency and die_bandwidth must be positive");
+  }
+
+  _wire_delay = config.GetFloat("wire_delay");
+
 #ifdef GPUNET_DEBUG
   cout << "GPUNet Configuration:" << endl;
   cout << "  l: " << _l << endl;
+  cout << "  dies: " << _dies << endl;
   cout << "  nodes_sm: " << _nodes_sm << endl;
   cout << "  nodes_l2slice: " << _nodes_l2slice << endl;
   cout << "  ratio: ";
@@ -109,6 +163,19 @@ void GPUNet::_ComputeSize( const Configuration& config )
   gN = _l;
   gX = _p;
   gU = _ratio;
+
+  // detours split the VCs of each message type in two
+  gGPUNetAdaptiveThreshold = config.GetInt("adaptive_threshold");
+  if ((config.GetStr("routing_function") == "adaptive") &&
+      (config.GetInt("num_vcs") < 4)) {
+    Error("adaptive routing needs at least four VCs");
+  }
+  // with lookahead routing a router routes its flits for the next router,
+  // so the detour choice reads the credits of a router stepped elsewhere
+  if ((config.GetStr("routing_function") == "adaptive") &&
+      (config.GetInt("routing_delay") == 0)) {
+    _RequireSerial();
+  }
 }
 
 void GPUNet::_BuildNet(const Configuration& config)
@@ -116,194 +183,435 @@ void GPUNet::_BuildNet(const Configuration& config)
   ostringstream name;
   int c, id;
 
-  // STEP 1: Create all routers first
-  for (int l = 0; l < _l; ++l) {
-    for (int addr = 0; addr < _total_units[l]; ++addr) {
-      id = _offsets[l] + addr;
+  // die-link ports come after the partition ports of the crossbars and
+  // may have their own buffer depth
+  int const die_vc_buf_size = config.GetInt("die_vc_buf_size");
+
+  for (int d = 0; d < _dies; ++d) {
+
+    // STEP 1: Create all routers first
+    for (int l = 0; l < _l; ++l) {
+      for (int addr = 0; addr < _total_units[l]; ++addr) {
+        id = _RouterID(d, l, addr);
       
-      int bottom_ports = (l < _l - 1) ? _ratio[l] : (_ratio[l] + (_p - 1));
-      int top_ports = (l < _l - 1) ? 1 : (_l2slice_p + (_p - 1));
-
-      name.str("");
-      name << "router_" << "request" << "_" << l << "_" << addr;
-      _routers[id] = Router::NewRouter(config, this, name.str(), id, bottom_ports, top_ports);
-      _timed_modules.push_back(_routers[id]);
-
-      name.str("");
-      name << "router_" << "reply" << "_" << l << "_" << addr;
-      _routers[id + _size / 2] = Router::NewRouter(config, this, name.str(), id + _size / 2, top_ports, bottom_ports);
-      _timed_modules.push_back(_routers[id + _size / 2]);
+        int bottom_ports = (l < _l - 1) ? _ratio[l] : (_ratio[l] + (_p - 1) + (_dies - 1));
+        int top_ports = (l < _l - 1) ? 1 : (_l2slice_p + (_p - 1) + (_dies - 1));
+
+        vector<int> bottom_buf_sizes, top_buf_sizes;
+        if ((l == _l - 1) && (_dies > 1) && (die_vc_buf_size > 0)) {
+          bottom_buf_sizes.resize(bottom_ports, 0);
+          top_buf_sizes.resize(top_ports, 0);
+          for (int port = 0; port < _dies - 1; ++port) {
+            bottom_buf_sizes[bottom_ports - 1 - port] = die_vc_buf_size;
+            top_buf_sizes[top_ports - 1 - port] = die_vc_buf_size;
+          }
+        }
+
+        name.str("");
+        name << "router_" << "request" << "_";
+        if (_dies > 1) {
+          name << d << "_";
+        }
+        name << l << "_" << addr;
+        _routers[id] = Router::NewRouter(config, this, name.str(), id, bottom_ports, top_ports,
+                                         {}, {}, bottom_buf_sizes, top_buf_sizes);
+        _timed_modules.push_back(_routers[id]);
+
+        name.str("");
+        name << "router_" << "reply" << "_";
+        if (_dies > 1) {
+          name << d << "_";
+        }
+        name << l << "_" << addr;
+        _routers[id + _size / 2] = Router::NewRouter(config, this, name.str(), id + _size / 2, top_ports, bottom_ports,
+                                                     {}, {}, top_buf_sizes, bottom_buf_sizes);
+        _timed_modules.push_back(_routers[id + _size / 2]);
+      }
     }
-  }
   
-  // STEP 2: Connect SM->TPC (injection) and TPC->SM (ejection) first
+    // STEP 2: Connect SM->TPC (injection) and TPC->SM (ejection) first
 #ifdef GPUNET_DEBUG
-  cout << "Connecting SM nodes..." << endl;
+    cout << "Connecting SM nodes..." << endl;
 #endif
 
-  for (int addr = 0; addr < _total_units[0]; ++addr) {
-    for (int port = 0; port < _ratio[0]; ++port) {
-      id = _offsets[0] + addr;
-      c = addr * _ratio[0] + port;  // SM node index
+    for (int addr = 0; addr < _total_units[0]; ++addr) {
+      for (int port = 0; port < _ratio[0]; ++port) {
+        id = _RouterID(d, 0, addr);
+        c = d * _sm_die + addr * _ratio[0] + port;  // SM node index
 
-      // Request network: SM -> TPC (injection)
-      _routers[id]->AddInputChannel(_inject[c], _inject_cred[c]);
+        // Request network: SM -> TPC (injection)
+        _routers[id]->AddInputChannel(_inject[c], _inject_cred[c]);
       
-      // Reply network: TPC -> SM (ejection)
-      _routers[id + _size / 2]->AddOutputChannel(_eject[c], _eject_cred[c]);
+        // Reply network: TPC -> SM (ejection)
+        _routers[id + _size / 2]->AddOutputChannel(_eject[c], _eject_cred[c]);
+      }
     }
-  }
   
-  // STEP 3: Connect L2->Crossbar (injection) and Crossbar->L2 (ejection)
+    // STEP 3: Connect L2->Crossbar (injection) and Crossbar->L2 (ejection)
 #ifdef GPUNET_DEBUG
-  cout << "Connecting L2 nodes..." << endl;
+    cout << "Connecting L2 nodes..." << endl;
 #endif
 
-  for (int addr = 0; addr < _total_units[_l - 1]; ++addr) {
-    for (int port = 0; port < _l2slice_p; ++port) {
-      id = _offsets[_l - 1] + addr;
-      c = _nodes_sm + addr * _l2slice_p + port;  // L2 node index
+    for (int addr = 0; addr < _total_units[_l - 1]; ++addr) {
+      for (int port = 0; port < _l2slice_p; ++port) {
+        id = _RouterID(d, _l - 1, addr);
+        c = _nodes_sm + d * _l2slice_die + addr * _l2slice_p + port;  // L2 node index
       
-      // Request network: Crossbar -> L2 (ejection)
-      _routers[id]->AddOutputChannel(_eject[c], _eject_cred[c]);
+        // Request network: Crossbar -> L2 (ejection)
+        _routers[id]->AddOutputChannel(_eject[c], _eject_cred[c]);
       
-      // Reply network: L2 -> Crossbar (injection)
-      _routers[id + _size / 2]->AddInputChannel(_inject[c], _inject_cred[c]);
+        // Reply network: L2 -> Crossbar (injection)
+        _routers[id + _size / 2]->AddInputChannel(_inject[c], _inject_cred[c]);
+      }
     }
-  }
   
-  // STEP 4: Connect internal network channels
+    // STEP 4: Connect internal network channels
 
 #ifdef GPUNET_DEBUG
-  cout << "Connecting internal channels of request network..." << endl;
+    cout << "Connecting internal channels of request network..." << endl;
 #endif
+
+    int const base = d * _die_channels;
   
-  // 4.1: Connect Request Network internal channels
-  for (int l = 0; l < _l; ++l) {
-    for (int addr = 0; addr < _total_units[l]; ++addr) {
-      id = _offsets[l] + addr;
+    // 4.1: Connect Request Network internal channels
+    for (int l = 0; l < _l; ++l) {
+      for (int addr = 0; addr < _total_units[l]; ++addr) {
+        id = _RouterID(d, l, addr);
       
-      // Connect bottom channels (from lower layer)
-      if (l > 0) {
-        for (int port = 0; port < _ratio[l]; ++port) {
-          c = _offsets[l - 1] + addr * _ratio[l] + port;
-          _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
+        // Connect bottom channels (from lower layer)
+        if (l > 0) {
+          for (int port = 0; port < _ratio[l]; ++port) {
+            c = base + _offsets[l - 1] + addr * _ratio[l] + port;
+            _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
+          }
         }
-      }
-
-      // Connect top channels (to higher layer)
-      if (l < _l - 1) {
-        c = _offsets[l] + addr;
-        _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
-      }
 
-      // Connect inter-partition channels for the last layer
-      if (l == _l - 1) {
-        for (int port = 0; port < (_p - 1); ++port) {
-          int src_partition = port;
-          if (src_partition >= addr) {
-            src_partition++;
-          }
+        // Connect top channels (to higher layer)
+        if (l < _l - 1) {
+          c = base + _offsets[l] + addr;
+          _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
+        }
 
-          int src_outport = addr;
-          if (src_outport > src_partition) {
-            src_outport--;
-          }
+        // Connect inter-partition channels for the last layer
+        if (l == _l - 1) {
+          for (int port = 0; port < (_p - 1); ++port) {
+            int src_partition = port;
+            if (src_partition >= addr) {
+              src_partition++;
+            }
+
+            int src_outport = addr;
+            if (src_outport > src_partition) {
+              src_outport--;
+            }
           
-          // For each partition router, output and input channels
-          // are connected in sequential port order.
-          // Output channel
-          c = _offsets[l] + addr * (_p - 1) + port;
-          _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
+            // For each partition router, output and input channels
+            // are connected in sequential port order.
+            // Output channel
+            c = base + _offsets[l] + addr * (_p - 1) + port;
+            _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
 
 #ifdef GPUNET_DEBUG
-          cout << "Connecting inter-partition channel " << c
-               << " as an output chnanel of partition " << addr
-               << " through outport " << port << endl;
+            cout << "Connecting inter-partition channel " << c
+                 << " as an output chnanel of partition " << addr
+                 << " through outport " << port << endl;
 #endif
           
-          // Input channel
-          c = _offsets[l] + src_partition * (_p - 1) + src_outport;
-          _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
+            // Input channel
+            c = base + _offsets[l] + src_partition * (_p - 1) + src_outport;
+            _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
 
 #ifdef GPUNET_DEBUG
-          cout << "Connecting inter-partition channel " << c
-               << " as an input channel from partition " << src_partition
-               << " using outport " << src_outport
-               << " to partition " << addr
-               << " through inport " << port << endl;
+            cout << "Connecting inter-partition channel " << c
+                 << " as an input channel from partition " << src_partition
+                 << " using outport " << src_outport
+                 << " to partition " << addr
+                 << " through inport " << port << endl;
 #endif
 
+          }
         }
       }
     }
-  }
   
 #ifdef GPUNET_DEBUG
-  cout << "Connecting internal channels of reply network..." << endl;
+    cout << "Connecting internal channels of reply network..." << endl;
 #endif
 
-  // 4.2: Connect Reply Network internal channels
-  for (int l = 0; l < _l; ++l) {
-    for (int addr = 0; addr < _total_units[l]; ++addr) {
-      id = _offsets[l] + addr + _size / 2;
+    // 4.2: Connect Reply Network internal channels
+    for (int l = 0; l < _l; ++l) {
+      for (int addr = 0; addr < _total_units[l]; ++addr) {
+        id = _RouterID(d, l, addr) + _size / 2;
       
-      // Connect bottom channels (to lower layer)
-      if (l > 0) {
-        for (int port = 0; port < _ratio[l]; ++port) {
-          c = _offsets[l - 1] + addr * _ratio[l] + port + _channels / 2;
-          _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
+        // Connect bottom channels (to lower layer)
+        if (l > 0) {
+          for (int port = 0; port < _ratio[l]; ++port) {
+            c = base + _offsets[l - 1] + addr * _ratio[l] + port + _channels / 2;
+            _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
+          }
         }
-      }
 
-      // Connect top channels (from higher layer)
-      if (l < _l - 1) {
-        c = _offsets[l] + addr + _channels / 2;
-        _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
-      }
+        // Connect top channels (from higher layer)
+        if (l < _l - 1) {
+          c = base + _offsets[l] + addr + _channels / 2;
+          _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
+        }
       
-      // Connect inter-partition channels for the last layer
-      if (l == _l - 1) {
-        for (int port = 0; port < (_p - 1); ++port) {
-          int src_partition = port;
-          if (src_partition >= addr) {
-            src_partition++;
-          }
-
-          int src_outport = addr;
-          if (src_outport > src_partition) {
-            src_outport--;
-          }
-
-          // For each partition router, output and input channels
-          // are connected in sequential port order.
-          // Output channel
-          c = _offsets[l] + addr * (_p - 1) + port + _channels / 2;
-          _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
+        // Connect inter-partition channels for the last layer
+        if (l == _l - 1) {
+          for (int port = 0; port < (_p - 1); ++port) {
+            int src_partition = port;
+            if (src_partition >= addr) {
+              src_partition++;
+            }
+
+            int src_outport = addr;
+            if (src_outport > src_partition) {
+              src_outport--;
+            }
+
+            // For each partition router, output and input channels
+            // are connected in sequential port order.
+            // Output channel
+            c = base + _offsets[l] + addr * (_p - 1) + port + _channels / 2;
+            _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
           
 #ifdef GPUNET_DEBUG
-          cout << "Connecting inter-partition channel " << c
-               << " as an output chnanel of partition " << addr
-               << " through outport " << port << endl;
+            cout << "Connecting inter-partition channel " << c
+                 << " as an output chnanel of partition " << addr
+                 << " through outport " << port << endl;
 #endif
-          // Input channel
-          c = _offsets[l] + src_partition * (_p - 1) + src_outport + _channels / 2;
-          _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
+            // Input channel
+            c = base + _offsets[l] + src_partition * (_p - 1) + src_outport + _channels / 2;
+            _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
 
 #ifdef GPUNET_DEBUG
-          cout << "Connecting inter-partition channel " << c
-               << " as an input channel from partition " << src_partition
-               << " using outport " << src_outport
-               << " to partition " << addr
-               << " through inport " << port << endl;
+            cout << "Connecting inter-partition channel " << c
+                 << " as an input channel from partition " << src_partition
+                 << " using outport " << src_outport
+                 << " to partition " << addr
+                 << " through inport " << port << endl;
 #endif
 
+          }
         }
       }
     }
+
+  }
+
+  // STEP 5: Connect die-to-die links between the crossbars of the same
+  // partition, after all partition ports and in the same port order
+  for (int d = 0; d < _dies; ++d) {
+    for (int addr = 0; addr < _p; ++addr) {
+      id = _RouterID(d, _l - 1, addr);
+      for (int port = 0; port < (_dies - 1); ++port) {
+        int const src_die = (port >= d) ? (port + 1) : port;
+        int const src_port = (d > src_die) ? (d - 1) : d;
+
+        c = _DieLinkID(d, port, addr);
+        _routers[id]->AddOutputChannel(_chan[c], _chan_cred[c]);
+        c = _DieLinkID(src_die, src_port, addr);
+        _routers[id]->AddInputChannel(_chan[c], _chan_cred[c]);
+
+        c = _DieLinkID(d, port, addr) + _channels / 2;
+        _routers[id + _size / 2]->AddOutputChannel(_chan[c], _chan_cred[c]);
+        c = _DieLinkID(src_die, src_port, addr) + _channels / 2;
+        _routers[id + _size / 2]->AddInputChannel(_chan[c], _chan_cred[c]);
+      }
+    }
+  }
+
+  _coords.resize(_nodes + _size / 2);
+  _placed.resize(_nodes + _size / 2, false);
+  string const floorplan_file = config.GetStr("floorplan_file");
+  if (!floorplan_file.empty()) {
+    _LoadFloorplan(floorplan_file);
   }
 
   _SetupChannels();
+  _BuildRoutes();
+}
+
+// Routes only depend on the router and the destination: every router
+// knows its die, layer and partition, so the hop count and source
+// partition the routing function used to derive them from are not
+// needed. Remote-die traffic crosses the die link at the crossbar of
+// its current partition first and changes partition on the far die.
+void GPUNet::_BuildRoutes()
+{
+  int const sm_p = _sm_die / _p; // SMs per partition
+
+  _routes.assign(_size * _nodes, -1);
+  _partition_ports.assign(_size * _p, -1);
+
+  for (int d = 0; d < _dies; ++d) {
+    int sm_group = 1; // SMs below one port of a reply router in layer l
+    for (int l = 0; l < _l; ++l) {
+      for (int addr = 0; addr < _total_units[l]; ++addr) {
+        int const id = _RouterID(d, l, addr);
+        int const partition = _partition ? addr : 0;
+
+        // request network: up to the partition crossbar, which either
+        // ejects to the L2 slice or forwards to the slice's die or
+        // partition
+        int * const request = &_routes[id * _nodes];
+        if (l == _l - 1) {
+          for (int q = 0; q < _p; ++q) {
+            if (q != partition) {
+              _partition_ports[id * _p + q] = _l2slice_p + ((q > partition) ? (q - 1) : q);
+              _partition_ports[(id + _size / 2) * _p + q] =
+                _ratio[_l - 1] + ((q > partition) ? (q - 1) : q);
+            }
+          }
+        }
+        for (int dest = _nodes_sm; dest < _nodes; ++dest) {
+          int const dest_die = (dest - _nodes_sm) / _l2slice_die;
+          int const dest_slice = (dest - _nodes_sm) % _l2slice_die;
+          if (l < _l - 1) {
+            request[dest] = 0;
+          } else {
+            assert(_routers[id]->NumOutputs() == _l2slice_p + (_p - 1) + (_dies - 1));
+            int const dest_partition = dest_slice / _l2slice_p;
+            if (dest_die != d) {
+              int const dest_port = (dest_die > d) ? (dest_die - 1) : dest_die;
+              request[dest] = _l2slice_p + (_p - 1) + dest_port;
+            } else if (dest_partition != partition) {
+              int const dest_port = (dest_partition > partition) ? (dest_partition - 1) : dest_partition;
+              request[dest] = _l2slice_p + dest_port;
+            } else {
+              request[dest] = dest_slice % _l2slice_p;
+            }
+          }
+        }
+
+        // reply network: the partition crossbar forwards to the SM's
+        // die or partition or descends, lower layers pick the subtree
+        // of the SM
+        int * const reply = &_routes[(id + _size / 2) * _nodes];
+        for (int dest = 0; dest < _nodes_sm; ++dest) {
+          int const dest_die = dest / _sm_die;
+          int const dest_sm = dest % _sm_die;
+          if (l < _l - 1) {
+            if (dest_die == d) {
+              reply[dest] = (dest_sm % (sm_group * _ratio[l])) / sm_group;
+            }
+          } else {
+            assert(_routers[id + _size / 2]->NumInputs() == _l2slice_p + (_p - 1) + (_dies - 1));
+            int const dest_partition = dest_sm / sm_p;
+            if (dest_die != d) {
+              int const dest_port = (dest_die > d) ? (dest_die - 1) : dest_die;
+              reply[dest] = _ratio[_l - 1] + (_p - 1) + dest_port;
+            } else if (dest_partition != partition) {
+              int const dest_port = (dest_partition > partition) ? (dest_partition - 1) : dest_partition;
+              reply[dest] = _ratio[_l - 1] + dest_port;
+            } else {
+              reply[dest] = (dest_sm % sm_p) / (sm_p / _ratio[_l - 1]);
+            }
+          }
+        }
+      }
+      sm_group *= _ratio[l];
+    }
+  }
+
+  gGPUNetRoutes = &_routes[0];
+  gGPUNetPartitionPorts = &_partition_ports[0];
+}
+
+// Floorplan file, one entry per line ('//' starts a comment):
+//   place <endpoint> <x> <y>
+//   bandwidth <endpoint> <endpoint> <flits per cycle>
+// where an endpoint is sm:<id>, l2slice:<id> or router:<layer>:<addr>,
+// with router addresses counted across dies like node ids.
+// Coordinates are in any unit; wire_delay gives cycles per unit of
+// Manhattan distance. Routers stand for both their request and reply
+// instance, and bandwidths apply to both directions of a link.
+void GPUNet::_LoadFloorplan(const string & filename)
+{
+  ifstream in(filename.c_str());
+  if (!in) {
+    Error("Cannot open floorplan file " + filename);
+  }
+
+  string line;
+  int line_no = 0;
+  while (getline(in, line)) {
+    ++line_no;
+    size_t const comment = line.find("//");
+    if (comment != string::npos) {
+      line.erase(comment);
+    }
+    istringstream tokens(line);
+    string cmd;
+    if (!(tokens >> cmd)) {
+      continue;
+    }
+
+    ostringstream where;
+    where << filename << ":" << line_no;
+
+    string a, b;
+    if (cmd == "place") {
+      double x, y;
+      if (!(tokens >> a >> x >> y)) {
+        Error("Malformed placement at " + where.str());
+      }
+      int const e = _ParseEndpoint(a);
+      if (e < 0) {
+        Error("Unknown endpoint " + a + " at " + where.str());
+      }
+      _coords[e] = make_pair(x, y);
+      _placed[e] = true;
+    } else if (cmd == "bandwidth") {
+      int bandwidth;
+      if (!(tokens >> a >> b >> bandwidth) || (bandwidth < 1)) {
+        Error("Malformed bandwidth at " + where.str());
+      }
+      int const ea = _ParseEndpoint(a);
+      int const eb = _ParseEndpoint(b);
+      if ((ea < 0) || (eb < 0)) {
+        Error("Unknown endpoint " + ((ea < 0) ? a : b) + " at " + where.str());
+      }
+      _link_bandwidth[make_pair(min(ea, eb), max(ea, eb))] = bandwidth;
+    } else {
+      Error("Unknown floorplan entry " + cmd + " at " + where.str());
+    }
+  }
+}
+
+// Maps an endpoint name to its index in _coords, -1 if invalid
+int GPUNet::_ParseEndpoint(const string & token) const
+{
+  size_t const sep = token.find(':');
+  if (sep == string::npos) {
+    return -1;
+  }
+  string const kind = token.substr(0, sep);
+  string const args = token.substr(sep + 1);
+
+  if ((kind == "sm") || (kind == "l2slice")) {
+    char * end;
+    int const id = strtol(args.c_str(), &end, 10);
+    if (args.empty() || *end) {
+      return -1;
+    }
+    if (kind == "sm") {
+      return ((id >= 0) && (id < _nodes_sm)) ? id : -1;
+    }
+    return ((id >= 0) && (id < _nodes_l2slice)) ? (_nodes_sm + id) : -1;
+  } else if (kind == "router") {
+    int layer, addr;
+    char tail;
+    if ((sscanf(args.c_str(), "%d:%d%c", &layer, &addr, &tail) != 2) ||
+        (layer < 0) || (layer >= _l) ||
+        (addr < 0) || (addr >= _dies * _total_units[layer])) {
+      return -1;
+    }
+    return _RouterEndpoint(addr / _total_units[layer], layer,
+                           addr % _total_units[layer]);
+  }
+  return -1;
 }
 
 // Set up all channel properties
@@ -313,33 +621,65 @@ void GPUNet::_SetupChannels()
   
   // Injection and Ejection channels
   for (int i = 0; i < _nodes_sm; i++) {
-    _SetChannelProperties(_inject[i], _inject_cred[i], 0);
-    _SetChannelProperties(_eject[i], _eject_cred[i], 0);
+    int const router = _RouterEndpoint(i / _sm_die, 0, (i % _sm_die) / _ratio[0]);
+    _SetChannelProperties(_inject[i], _inject_cred[i], 0, i, router);
+    _SetChannelProperties(_eject[i], _eject_cred[i], 0, i, router);
   }
 
   for (int i = _nodes_sm; i < _nodes; i++) {
-    _SetChannelProperties(_inject[i], _inject_cred[i], _l);
-    _SetChannelProperties(_eject[i], _eject_cred[i], _l);
+    int const slice = i - _nodes_sm;
+    int const router = _RouterEndpoint(slice / _l2slice_die, _l - 1, (slice % _l2slice_die) / _l2slice_p);
+    _SetChannelProperties(_inject[i], _inject_cred[i], _l, i, router);
+    _SetChannelProperties(_eject[i], _eject_cred[i], _l, i, router);
   }
   
-  for (int l = 1; l < _l; l++) {
-    int start = _offsets[l - 1];
-    int end = _offsets[l];
+  for (int d = 0; d < _dies; d++) {
+    int const base = d * _die_channels;
+
+    for (int l = 1; l < _l; l++) {
+      int start = _offsets[l - 1];
+      int end = _offsets[l];
+      
+      // TPC <-> CPC, CPC <-> GPC, GPC <-> Crossbar channels
+      for (int c = start; c < end; c++) {
+        int const lower = _RouterEndpoint(d, l - 1, c - start);
+        int const upper = _RouterEndpoint(d, l, (c - start) / _ratio[l]);
+        _SetChannelProperties(_chan[base + c], _chan_cred[base + c], l, lower, upper);
+        _SetChannelProperties(_chan[base + c + _channels / 2], _chan_cred[base + c + _channels / 2], l, lower, upper);
+      }
+    }
     
-    // TPC <-> CPC, CPC <-> GPC, GPC <-> Crossbar channels
-    for (int c = start; c < end; c++) {
-      _SetChannelProperties(_chan[c], _chan_cred[c], l);
-      _SetChannelProperties(_chan[c + _channels / 2], _chan_cred[c + _channels / 2], l);
+    // interpartition channels for the last layer
+    if (_partition) {
+      for (int addr = 0; addr < _p; addr++) {
+        for (int port = 0; port < (_p - 1); port++) {
+          int const c = base + _offsets[_l - 1] + addr * (_p - 1) + port;
+          int const dest = (port >= addr) ? (port + 1) : port;
+          int const src_router = _RouterEndpoint(d, _l - 1, addr);
+          int const dest_router = _RouterEndpoint(d, _l - 1, dest);
+          _SetChannelProperties(_chan[c], _chan_cred[c], _l - 1, src_router, dest_router, true);
+          _SetChannelProperties(_chan[c + _channels / 2], _chan_cred[c + _channels / 2], _l - 1, src_router, dest_router, true);
+        }
+      }
     }
-  }
-  
-  // interpartition channels for the last layer
-  if (_partition) {
-    int p_start = _offsets[_l - 1];
-    int p_end = _offsets[_l - 1] + _p * (_p - 1);
-    for (int c = p_start; c < p_end; c++) {
-      _SetChannelProperties(_chan[c], _chan_cred[c], _l - 1, true);
-      _SetChannelProperties(_chan[c + _channels / 2], _chan_cred[c + _channels / 2], _l - 1, true);
+
+    // die-to-die links have their own latency regardless of placement
+    for (int addr = 0; addr < _p; addr++) {
+      for (int port = 0; port < (_dies - 1); port++) {
+        int const c = _DieLinkID(d, port, addr);
+        int const dest = (port >= d) ? (port + 1) : port;
+        int const bandwidth = _LinkBandwidth(_RouterEndpoint(d, _l - 1, addr),
+                                             _RouterEndpoint(dest, _l - 1, addr),
+                                             _die_bandwidth);
+        _chan[c]->SetLatency(_die_latency);
+        _chan[c]->SetBandwidth(bandwidth);
+        _chan_cred[c]->SetLatency(_die_latency);
+        _chan_cred[c]->SetBandwidth(bandwidth);
+        _chan[c + _channels / 2]->SetLatency(_die_latency);
+        _chan[c + _channels / 2]->SetBandwidth(bandwidth);
+        _chan_cred[c + _channels / 2]->SetLatency(_die_latency);
+        _chan_cred[c + _channels / 2]->SetBandwidth(bandwidth);
+      }
     }
   }
   
@@ -348,10 +688,15 @@ void GPUNet::_SetupChannels()
 }
 
 // Set channel latency and bandwidth based on layer properties
-void GPUNet::_SetChannelProperties(FlitChannel* channel, CreditChannel* credit_channel, int layer, bool is_inter_partition)
+void GPUNet::_SetChannelProperties(FlitChannel* channel, CreditChannel* credit_channel, int layer, int a, int b, bool is_inter_partition)
 {
   int latency = _GetWireLatency(layer, is_inter_partition);
-  int bandwidth = _GetChannelBandwidth(layer, is_inter_partition);
+  if (_placed[a] && _placed[b]) {
+    latency = _FloorplanLatency(_coords[a].first, _coords[a].second,
+                                _coords[b].first, _coords[b].second);
+  }
+
+  int bandwidth = _LinkBandwidth(a, b, _GetChannelBandwidth(layer, is_inter_partition));
   
   channel->SetLatency(latency);
   channel->SetBandwidth(bandwidth);
@@ -359,6 +704,14 @@ void GPUNet::_SetChannelProperties(FlitChannel* channel, CreditChannel* credit_c
   credit_channel->SetBandwidth(bandwidth);
 }
 
+// Floorplan bandwidth of the link between endpoints a and b, if given
+int GPUNet::_LinkBandwidth(int a, int b, int bandwidth) const
+{
+  map<pair<int, int>, int>::const_iterator iter =
+    _link_bandwidth.find(make_pair(min(a, b), max(a, b)));
+  return (iter != _link_bandwidth.end()) ? iter->second : bandwidth;
+}
+
 int GPUNet::_GetWireLatency(int layer, bool is_inter_partition) const
 {
   // Base latency increases with layer depth
@@ -377,15 +730,18 @@ int GPUNet::_GetChannelBandwidth(int layer, bool is_inter_partition) const
   return is_inter_partition ? _inter_partition_speedup : _speedups[layer];
 }
 
-int GPUNet::_FloorplanLatency(int src_x, int src_y, int dst_x, int dst_y) const
+// Wire delay over the Manhattan distance, at least one cycle
+int GPUNet::_FloorplanLatency(double src_x, double src_y, double dst_x, double dst_y) const
 {
-  return abs(src_x - dst_x) + abs(src_y - dst_y);
+  double const distance = fabs(src_x - dst_x) + fabs(src_y - dst_y);
+  return max(1, (int)ceil(distance * _wire_delay));
 }
 
 
 void GPUNet::RegisterRoutingFunctions()
 {
   gRoutingFunctionMap["hierarchical_gpunet"] = &hierarchical_gpunet;
+  gRoutingFunctionMap["adaptive_gpunet"] = &adaptive_gpunet;
   // gRoutingFunctionMap["direct_fullyconnected"] = &direct_fullyconnected;
 
 }
@@ -402,83 +758,95 @@ void hierarchical_gpunet(const Router *r, const Flit *f, int in_channel, OutputS
   }
   assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
-  int out_port;
-  
   if (inject) {
     // injection can use all VCs
     outputs->AddRange(-1, vcBegin, vcEnd);
     return;
   }
 
-  int src = f->src;
-  int dest = f->dest;
-  int hops = f->hops;
+  int const out_port = gGPUNetRoutes[r->GetID() * gNodes + f->dest];
+  assert(out_port >= 0);
 
-  // cout << "router: " << r->GetID() 
-  //      << ", time: " << GetSimTime() << endl;
-
-  // cout << "Routing flit: " << f->id
-  //      <<  " src: " << src 
-  //      << ", dest: " << dest 
-  //      << ", hops: " << f->hops << endl;
-
-  // # of SMs and L2 Slices per partition
-  int sm = gX;
-  for (int i = 0; i < gN; ++i) {
-    sm *= gU[i];
+  if (f->watch) {
+    *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
+               << "Adding VC range ["
+               << vcBegin << ","
+               << vcEnd << "]"
+               << " at output port " << out_port
+               << " for flit " << f->id
+               << " (input port " << in_channel
+               << ", destination " << f->dest << ")"
+               << "." << endl;
   }
-  int sm_p = sm / gX; // SMs per partition
-  int l2slice = gNodes - sm;
-  int l2slice_p = l2slice / gX; // L2 slices per partition
 
-  assert((src < sm && dest >= sm) || (src >= sm && dest < sm));
-  bool is_request = dest > src;
+  outputs->Clear( );
 
-  int src_partition = is_request ? (src / sm_p) : ((src - sm) / l2slice_p);
-  int dest_partition = is_request ? ((dest - sm) / l2slice_p) : (dest / sm_p);
-  bool is_remote = (dest_partition != src_partition);
+  outputs->AddRange( out_port, vcBegin, vcEnd );
+}
 
-  // if remote access is required, add one additional hop,
-  // in the case of fully-connected partitioned network
-  int total_hops = is_remote ? (gN + 1) : gN;
-  int cur_layer = is_request ? hops : (total_hops - hops - 1);
+// Like hierarchical_gpunet, but a partition crossbar may send traffic for
+// another partition of its die through a third one when the direct link
+// is backed up (UGAL-style, comparing the used credits of the direct
+// link against twice those of the least loaded detour). The first hop
+// of a detour uses the lower half of the message type's VCs and every
+// final inter-partition hop the upper half, which keeps the
+// inter-partition links free of cyclic dependencies.
+void adaptive_gpunet(const Router *r, const Flit *f, int in_channel, OutputSet *outputs, bool inject)
+{
+  int vcBegin = 0, vcEnd = gNumVCs - 1;
+  if (f->type == Flit::READ_REQUEST || f->type == Flit::READ_REPLY) {
+    vcBegin = 0;
+    vcEnd = gNumVCs / 2 - 1;
+  } else if (f->type == Flit::WRITE_REQUEST || f->type == Flit::WRITE_REPLY) {
+    vcBegin = gNumVCs / 2;
+    vcEnd = gNumVCs - 1;
+  }
+  assert(((f->vc >= vcBegin) && (f->vc <= vcEnd)) || (inject && (f->vc < 0)));
 
-  if (is_request) {
-    // request network
-    if (cur_layer < gN - 1) {
-      out_port = 0;
-    } else {
-      // partition layer
-      assert(r->NumOutputs() == l2slice_p + (gX - 1));
+  if (inject) {
+    outputs->AddRange(-1, vcBegin, vcEnd);
+    return;
+  }
 
-      if (is_remote && (cur_layer == total_hops - 2)) {
-        // inter-partition communication
-        int dest_port = (dest_partition > src_partition) ? (dest_partition - 1) : dest_partition;
-        out_port = l2slice_p + dest_port;
-      } else {
-        // intra-partition communication or already crossed inter-partition
-        out_port = (dest - sm) % l2slice_p;
-      }
+  int const id = r->GetID();
+  int out_port = gGPUNetRoutes[id * gNodes + f->dest];
+  assert(out_port >= 0);
+
+  // partition the minimal route leads to, if it changes partition here
+  int const * const ports = &gGPUNetPartitionPorts[id * gX];
+  int dest_partition = -1;
+  for (int q = 0; q < gX; ++q) {
+    if (ports[q] == out_port) {
+      dest_partition = q;
+      break;
     }
-  } else {
-    // reply network
-    if (cur_layer < gN - 1) {
-      int sm_group = 1;
-      for (int i = 0; i < cur_layer; ++i) {
-        sm_group *= gU[i];
-      }
-      out_port = (dest % (sm_group * gU[cur_layer])) / sm_group;
-    } else {
-      // partition layer
-      assert(r->NumInputs() == l2slice_p + (gX - 1));
+  }
 
-      if (is_remote && (cur_layer == total_hops - 1)) {
-        // inter-partition communication
-        int dest_port = (dest_partition > src_partition) ? (dest_partition - 1) : dest_partition; 
-        out_port = gU[gN - 1] + dest_port;
+  if (dest_partition >= 0) {
+    int const vcSplit = vcBegin + (vcEnd - vcBegin + 1) / 2;
+    if (f->ph == 1) {
+      // second hop of a detour
+      vcBegin = vcSplit;
+    } else {
+      int const min_queue = max(r->GetUsedCredit(out_port), 0);
+      int detour = -1;
+      int detour_queue = 0;
+      for (int q = 0; q < gX; ++q) {
+        if ((ports[q] >= 0) && (q != dest_partition)) {
+          int const queue = max(r->GetUsedCredit(ports[q]), 0);
+          if ((detour < 0) || (queue < detour_queue)) {
+            detour = q;
+            detour_queue = queue;
+          }
+        }
+      }
+      if ((detour >= 0) &&
+          (min_queue > 2 * detour_queue + gGPUNetAdaptiveThreshold)) {
+        f->ph = 1;
+        out_port = ports[detour];
+        vcEnd = vcSplit - 1;
       } else {
-        // intra-partition communication or already crossed inter-partition
-        out_port = (dest % sm_p) / (sm_p / gU[gN - 1]);
+        vcBegin = vcSplit;
       }
     }
   }
@@ -491,11 +859,12 @@ void hierarchical_gpunet(const Router *r, const Flit *f, int in_channel, OutputS
                << " at output port " << out_port
                << " for flit " << f->id
                << " (input port " << in_channel
-               << ", destination " << f->dest << ")"
+               << ", destination " << f->dest
+               << ((f->ph == 1) ? ", detour" : "") << ")"
                << "." << endl;
   }
 
   outputs->Clear( );
 
   outputs->AddRange( out_port, vcBegin, vcEnd );
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #define _GPUNET_HPP_
 #include <cassert>
 #include <vector>
+#include <map>
 
 #include "network.hpp"
 #include "routefunc.hpp"
@@ -12,8 +13,18 @@ class GPUNet : public Network {
   // ex) (_l == 3): SM->TPC->GPC->Crossbar, (_l == 4): SM->TPC->CPC->GPC->Crossbar
   int _l;
 
+  // # of GPU dies, each a full hierarchy; node ids list the SMs of all
+  // dies first, then their L2 slices
+  int _dies;
+  int _die_routers;  // routers per die and direction
+  int _die_channels; // channels per die and direction
+  int _die_latency;
+  int _die_bandwidth;
+
   int _nodes_sm;
   int _nodes_l2slice;
+  int _sm_die;
+  int _l2slice_die;
   int _l2slice_p;
   
   // # of lower-level units connected to a single higher-level module.
@@ -37,20 +48,49 @@ class GPUNet : public Network {
 
   
 
-  vector<pair<int, int> > _l2slice_coords;
+  // floorplan: coordinates of SMs and L2 slices (by node id) and of
+  // request routers (by _nodes + router id), and per-link bandwidths
+  // keyed by the two endpoints in increasing order
+  vector<pair<double, double> > _coords;
+  vector<bool> _placed;
+  map<pair<int, int>, int> _link_bandwidth;
+  double _wire_delay;
+
+  // output port per router and destination node, -1 where the
+  // destination cannot be reached from that router
+  vector<int> _routes;
+  // output port per router and partition on its die, -1 unless the
+  // router is a partition crossbar linked to that partition
+  vector<int> _partition_ports;
 
   void _ComputeSize(const Configuration& config);
   void _BuildNet(const Configuration& config);
+  void _BuildRoutes();
 
-  // Set latency and bandwidth for a channel based on its layer
+  void _LoadFloorplan(const string & filename);
+  int _ParseEndpoint(const string & token) const;
+  inline int _RouterID(int die, int layer, int addr) const {
+    return die * _die_routers + _offsets[layer] + addr;
+  }
+  inline int _RouterEndpoint(int die, int layer, int addr) const {
+    return _nodes + _RouterID(die, layer, addr);
+  }
+  // request channel from a crossbar to the same partition on another
+  // die, port counting the other dies in increasing order
+  inline int _DieLinkID(int die, int port, int partition) const {
+    return _dies * _die_channels + (die * (_dies - 1) + port) * _p + partition;
+  }
+
+  // Set latency and bandwidth for a channel between endpoints a and b,
+  // from the floorplan where available and from its layer otherwise
   void _SetupChannels();
   void _SetChannelProperties(FlitChannel* channel, CreditChannel* credit_channel,
-                   int layer, bool is_inter_partition = false);
+                   int layer, int a, int b, bool is_inter_partition = false);
   int _GetWireLatency(int layer, bool is_inter_partition = false) const;
   int _GetChannelBandwidth(int layer, bool is_inter_partition = false) const;
+  int _LinkBandwidth(int a, int b, int bandwidth) const;
   
-  int _WireLatency(int l) const;
-  int _FloorplanLatency(int src_x, int src_y, int dst_x, int dst_y) const;
+  int _FloorplanLatency(double src_x, double src_y, double dst_x, double dst_y) const;
 
 public:
 
@@ -58,7 +98,20 @@ public:
   static void RegisterRoutingFunctions();
 };
 
+// routing parameters of the GPUNet built on this thread
+extern thread_local int gX;
+extern thread_local vector<int> gU;
+// routing table of the GPUNet built on this thread, indexed by
+// router * gNodes + destination
+extern thread_local int const * gGPUNetRoutes;
+// inter-partition ports of the same GPUNet, indexed by router * gX +
+// partition, and the bias of adaptive routing towards the direct link
+extern thread_local int const * gGPUNetPartitionPorts;
+extern thread_local int gGPUNetAdaptiveThreshold;
+
 void hierarchical_gpunet( const Router *r, const Flit *f, int in_channel,
                    OutputSet *outputs, bool inject );
+void adaptive_gpunet( const Router *r, const Flit *f, int in_channel,
+                      OutputSet *outputs, bool inject );
 
 #endif
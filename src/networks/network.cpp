@@ -34,9 +34,13 @@
 
 #include <cassert>
 #include <sstream>
+#include <algorithm>
 
 #include "booksim.hpp"
 #include "network.hpp"
+#include "sim_context.hpp"
+#include "checkpoint.hpp"
+#include "random_utils.hpp"
 
 #include "kncube.hpp"
 #include "fly.hpp"
@@ -57,10 +61,17 @@ Network::Network( const Configuration &config, const string & name ) :
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+  _threads  = config.GetInt("threads");
+  _pool     = NULL;
+  _phase    = NULL;
+  if ( _threads < 1 ) {
+    Error( "threads must be at least 1" );
+  }
 }
 
 Network::~Network( )
 {
+  if ( _pool ) delete _pool;
   for ( int r = 0; r < _size; ++r ) {
     if ( _routers[r] ) delete _routers[r];
   }
@@ -183,30 +194,130 @@ void Network::_Alloc( )
   }
 }
 
-void Network::ReadInputs( )
+/* modules only touch their own state (and the input side of the channels
+ * they drive) within a phase, so the shards of a phase can be stepped
+ * concurrently as long as all of them finish before the next phase starts
+ */
+void Network::_BuildShards( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->ReadInputs( );
+  // watched flits write to a shared trace stream from within the phases
+  if ( gWatchOut ) {
+    _threads = 1;
+  }
+  int const workers = min( _threads, (int)_timed_modules.size( ) );
+  if ( workers <= 1 ) {
+    _threads = 1;
+    return;
+  }
+
+  // routers are appended after the channels, so deal modules out round-robin
+  // to give every worker a similar mix
+  _shards.resize( workers );
+  for ( size_t m = 0; m < _timed_modules.size( ); ++m ) {
+    _shards[m % workers].push_back( _timed_modules[m] );
   }
+  Credit::SetThreadSafe( true );
+  Flit::SetThreadSafe( true );
+  _pool = new WorkerPool( workers );
+
+  // workers share the pools and globals of the simulation driving them
+  SimContext * const context = SimContext::Current( );
+  assert( context );
+  context->Capture( );
+  _pool->Run( &Network::_BindWorker, context );
 }
 
-void Network::Evaluate( )
+void Network::_BindWorker( void * context, int worker )
+{
+  if ( worker > 0 ) {
+    SimContext * const c = static_cast<SimContext *>( context );
+    c->Bind( );
+    // randomness in the modules of this worker, e.g. in allocators,
+    // follows the configured seed but is not shared with other workers
+    RandomSeed( c->Seed( ) + worker );
+  }
+}
+
+void Network::_StepShard( void * net, int worker )
+{
+  Network * const n = static_cast<Network *>( net );
+  vector<TimedModule *> const & shard = n->_shards[worker];
+  for ( size_t m = 0; m < shard.size( ); ++m ) {
+    ( shard[m]->*( n->_phase ) )( );
+  }
+}
+
+void Network::_RunPhase( void (TimedModule::*phase)( ) )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->Evaluate( );
+  if ( ( _threads > 1 ) && !_pool ) {
+    _BuildShards( );
+  }
+  if ( _pool ) {
+    _phase = phase;
+    _pool->Run( &Network::_StepShard, this );
+  } else {
+    for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+	iter != _timed_modules.end();
+	++iter) {
+      ( (*iter)->*phase )( );
+    }
   }
 }
 
+void Network::ReadInputs( )
+{
+  _RunPhase( &TimedModule::ReadInputs );
+}
+
+void Network::Evaluate( )
+{
+  _RunPhase( &TimedModule::Evaluate );
+}
+
 void Network::WriteOutputs( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->WriteOutputs( );
+  _RunPhase( &TimedModule::WriteOutputs );
+}
+
+void Network::Save( CheckpointWriter & w ) const
+{
+  w.Section( Name( ) );
+  w.Write( _size );
+  w.Write( _nodes );
+  w.Write( _channels );
+  for ( int r = 0; r < _size; ++r ) {
+    _routers[r]->Save( w );
+  }
+  for ( int n = 0; n < _nodes; ++n ) {
+    _inject[n]->Save( w );
+    _inject_cred[n]->Save( w );
+    _eject[n]->Save( w );
+    _eject_cred[n]->Save( w );
+  }
+  for ( int c = 0; c < _channels; ++c ) {
+    _chan[c]->Save( w );
+    _chan_cred[c]->Save( w );
+  }
+}
+
+void Network::Load( CheckpointReader & r )
+{
+  r.Section( Name( ) );
+  r.Expect( _size, "number of routers" );
+  r.Expect( _nodes, "number of nodes" );
+  r.Expect( _channels, "number of channels" );
+  for ( int i = 0; i < _size; ++i ) {
+    _routers[i]->Load( r );
+  }
+  for ( int n = 0; n < _nodes; ++n ) {
+    _inject[n]->Load( r );
+    _inject_cred[n]->Load( r );
+    _eject[n]->Load( r );
+    _eject_cred[n]->Load( r );
+  }
+  for ( int c = 0; c < _channels; ++c ) {
+    _chan[c]->Load( r );
+    _chan_cred[c]->Load( r );
   }
 }
 
@@ -41,6 +41,7 @@
 #include "channel.hpp"
 #include "config_utils.hpp"
 #include "globals.hpp"
+#include "worker_pool.hpp"
 
 typedef Channel<Credit> CreditChannel;
 
@@ -66,6 +67,22 @@ protected:
 
   deque<TimedModule *> _timed_modules;
 
+  // parallel engine: each worker steps its own shard of _timed_modules
+  int _threads;
+  WorkerPool * _pool;
+  vector<vector<TimedModule *> > _shards;
+  void (TimedModule::*_phase)( );
+
+  void _BuildShards( );
+  void _RunPhase( void (TimedModule::*phase)( ) );
+  static void _StepShard( void * net, int worker );
+  static void _BindWorker( void * context, int worker );
+
+  // step every module on the calling thread; for topologies whose routing
+  // functions keep per-thread statics that SimContext does not carry over
+  // to the workers
+  inline void _RequireSerial( ) { _threads = 1; }
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
@@ -94,6 +111,10 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( );
 
+  // state of all routers and channels between two cycles
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
@@ -38,9 +38,16 @@
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+OutputSet::OutputSet( )
+  : _size( 0 )
+{
+
+}
+
 void OutputSet::Clear( )
 {
-  _outputs.clear( );
+  _size = 0;
+  _spill.clear( );
 }
 
 void OutputSet::Add( int output_port, int vc, int pri  )
@@ -57,41 +64,55 @@ void OutputSet::AddRange( int output_port, int vc_start, int vc_end, int pri )
   s.vc_end   = vc_end;
   s.pri      = pri;
   s.output_port = output_port;
-  _outputs.insert( s );
+
+  // higher priorities first; like the std::set this replaces, a second
+  // candidate with an already present priority is ignored
+  sSetElement const * const data = _Data( );
+  int pos = 0;
+  while ( ( pos < _size ) && ( data[pos].pri > pri ) ) {
+    ++pos;
+  }
+  if ( ( pos < _size ) && ( data[pos].pri == pri ) ) {
+    return;
+  }
+
+  if ( _size < _inline_size ) {
+    for ( int i = _size; i > pos; --i ) {
+      _inline[i] = _inline[i-1];
+    }
+    _inline[pos] = s;
+  } else {
+    if ( _size == _inline_size ) {
+      _spill.assign( _inline, _inline + _inline_size );
+    }
+    _spill.insert( _spill.begin( ) + pos, s );
+  }
+  ++_size;
 }
 
-//legacy support, for performance, just use GetSet()
+//legacy support, for performance, just iterate over begin()/end()
 int OutputSet::NumVCs( int output_port ) const
 {
   int total = 0;
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  for ( const_iterator i = begin( ); i != end( ); ++i ) {
     if(i->output_port == output_port){
       total += (i->vc_end - i->vc_start + 1);
     }
-    i++;
   }
   return total;
 }
 
 bool OutputSet::OutputEmpty( int output_port ) const
 {
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  for ( const_iterator i = begin( ); i != end( ); ++i ) {
     if(i->output_port == output_port){
       return false;
     }
-    i++;
   }
   return true;
 }
 
-
-const set<OutputSet::sSetElement> & OutputSet::GetSet() const{
-  return _outputs;
-}
-
-//legacy support, for performance, just use GetSet()
+//legacy support, for performance, just iterate over begin()/end()
 int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
 {
 
@@ -101,8 +122,7 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
   
   if ( pri ) { *pri = -1; }
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  for ( const_iterator i = begin( ); i != end( ); ++i ) {
     if(i->output_port == output_port){
       range = i->vc_end - i->vc_start + 1;
       if ( remaining >= range ) {
@@ -115,12 +135,11 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
 	break;
       }
     }
-    i++;
   }
   return vc;
 }
 
-//legacy support, for performance, just use GetSet()
+//legacy support, for performance, just iterate over begin()/end()
 bool OutputSet::GetPortVC( int *out_port, int *out_vc ) const
 {
 
@@ -128,11 +147,11 @@ bool OutputSet::GetPortVC( int *out_port, int *out_vc ) const
   bool single_output = false;
   int  used_outputs  = 0;
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  if(i!=_outputs.end( )){
+  const_iterator i = begin( );
+  if(i!=end( )){
     used_outputs = i->output_port;
   }
-  while(i!=_outputs.end( )){
+  while(i!=end( )){
 
     if ( i->vc_start == i->vc_end ) {
       *out_vc   = i->vc_start;
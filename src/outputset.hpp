@@ -28,8 +28,10 @@
 #ifndef _OUTPUTSET_HPP_
 #define _OUTPUTSET_HPP_
 
-#include <set>
+#include <vector>
 
+// route candidates ordered by decreasing priority; kept inline, and only
+// moved to the heap when a routing function produces many candidates
 class OutputSet {
 
 
@@ -41,6 +43,10 @@ public:
     int output_port;
   };
 
+  typedef sSetElement const * const_iterator;
+
+  OutputSet( );
+
   void Clear( );
   void Add( int output_port, int vc, int pri = 0 );
   void AddRange( int output_port, int vc_start, int vc_end, int pri = 0 );
@@ -48,19 +54,23 @@ public:
   bool OutputEmpty( int output_port ) const;
   int NumVCs( int output_port ) const;
   
-  const set<sSetElement> & GetSet() const;
+  inline const_iterator begin( ) const { return _Data( ); }
+  inline const_iterator end( ) const { return _Data( ) + _size; }
+  inline int Size( ) const { return _size; }
+  inline bool Empty( ) const { return _size == 0; }
 
   int  GetVC( int output_port,  int vc_index, int *pri = 0 ) const;
   bool GetPortVC( int *out_port, int *out_vc ) const;
 private:
-  set<sSetElement> _outputs;
-};
+  static const int _inline_size = 4;
 
-inline bool operator<(const OutputSet::sSetElement & se1, 
-	       const OutputSet::sSetElement & se2) {
-  return se1.pri > se2.pri; // higher priorities first!
-}
-
-#endif
+  int _size;
+  sSetElement _inline[_inline_size];
+  vector<sSetElement> _spill;
 
+  inline sSetElement const * _Data( ) const {
+    return ( _size > _inline_size ) ? &_spill[0] : _inline;
+  }
+};
 
+#endif
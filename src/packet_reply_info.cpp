@@ -27,31 +27,43 @@
 
 #include "packet_reply_info.hpp"
 
-stack<PacketReplyInfo*> PacketReplyInfo::_all;
-stack<PacketReplyInfo*> PacketReplyInfo::_free;
+thread_local PacketReplyInfo::Pool * PacketReplyInfo::_pool = NULL;
 
 PacketReplyInfo * PacketReplyInfo::New()
 {
   PacketReplyInfo * pr;
-  if(_free.empty()) {
+  if(_pool->free.empty()) {
     pr = new PacketReplyInfo();
-    _all.push(pr);
+    _pool->all.push(pr);
   } else {
-    pr = _free.top();
-    _free.pop();
+    pr = _pool->free.top();
+    _pool->free.pop();
   }
   return pr;
 }
 
 void PacketReplyInfo::Free()
 {
-  _free.push(this);
+  _pool->free.push(this);
 }
 
 void PacketReplyInfo::FreeAll()
 {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  _pool->Release();
+}
+
+void PacketReplyInfo::Pool::Release()
+{
+  while(!all.empty()) {
+    delete all.top();
+    all.pop();
+  }
+  while(!free.empty()) {
+    free.pop();
   }
 }
+
+void PacketReplyInfo::SetPool(Pool * pool)
+{
+  _pool = pool;
+}
@@ -45,10 +45,18 @@ public:
   void Free();
   static void FreeAll();
 
+  // reply records of one simulation; owned by its SimContext
+  struct Pool {
+    stack<PacketReplyInfo*> all;
+    stack<PacketReplyInfo*> free;
+    ~Pool() { Release(); }
+    void Release();
+  };
+  static void SetPool(Pool * pool);
+
 private:
 
-  static stack<PacketReplyInfo*> _all;
-  static stack<PacketReplyInfo*> _free;
+  static thread_local Pool * _pool;
 
   PacketReplyInfo() {}
   ~PacketReplyInfo() {}
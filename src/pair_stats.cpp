@@ -0,0 +1,109 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <cassert>
+#include <algorithm>
+
+#include "pair_stats.hpp"
+
+PairStats::PairStats( ) : _size( 0 )
+{
+  _empty.packets = 0;
+  _empty.plat_sum = 0.0;
+  _empty.nlat_sum = 0.0;
+  _empty.flits = 0;
+  _empty.flat_sum = 0.0;
+}
+
+void PairStats::Clear( )
+{
+  _keys.clear( );
+  _entries.clear( );
+  _size = 0;
+}
+
+// slot holding the pair, or the empty slot where it would go
+int PairStats::_Slot( int pair ) const
+{
+  assert( pair >= 0 );
+  unsigned const mask = _keys.size( ) - 1;
+  unsigned slot = ( (unsigned)pair * 2654435761u ) & mask;
+  while ( ( _keys[slot] >= 0 ) && ( _keys[slot] != pair ) ) {
+    slot = ( slot + 1 ) & mask;
+  }
+  return slot;
+}
+
+PairStats::Entry & PairStats::_Insert( int pair )
+{
+  // keep the table at most half full
+  if ( 2 * ( _size + 1 ) > (int)_keys.size( ) ) {
+    vector<int> keys( max( (size_t)64, 2 * _keys.size( ) ), -1 );
+    vector<Entry> entries( keys.size( ) );
+    keys.swap( _keys );
+    entries.swap( _entries );
+    for ( size_t i = 0; i < keys.size( ); ++i ) {
+      if ( keys[i] >= 0 ) {
+        int const slot = _Slot( keys[i] );
+        _keys[slot] = keys[i];
+        _entries[slot] = entries[i];
+      }
+    }
+  }
+  int const slot = _Slot( pair );
+  if ( _keys[slot] < 0 ) {
+    _keys[slot] = pair;
+    _entries[slot] = _empty;
+    ++_size;
+  }
+  return _entries[slot];
+}
+
+void PairStats::AddPacket( int pair, int plat, int nlat )
+{
+  Entry & e = _Insert( pair );
+  ++e.packets;
+  e.plat_sum += plat;
+  e.nlat_sum += nlat;
+}
+
+void PairStats::AddFlit( int pair, int flat )
+{
+  Entry & e = _Insert( pair );
+  ++e.flits;
+  e.flat_sum += flat;
+}
+
+PairStats::Entry const & PairStats::Find( int pair ) const
+{
+  if ( _keys.empty( ) ) {
+    return _empty;
+  }
+  int const slot = _Slot( pair );
+  return ( _keys[slot] < 0 ) ? _empty : _entries[slot];
+}
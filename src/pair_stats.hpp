@@ -0,0 +1,78 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*pair_stats.hpp
+ *
+ *Latency sums per (source, destination) pair, for the pair_* outputs of
+ *pair_stats. Only the pairs that carried traffic get an entry, in an
+ *open-addressing hash table keyed by source * nodes + destination
+ *
+ */
+
+#ifndef _PAIR_STATS_HPP_
+#define _PAIR_STATS_HPP_
+
+#include <vector>
+
+using namespace std;
+
+class PairStats {
+
+public:
+
+  struct Entry {
+    int packets;
+    double plat_sum;
+    double nlat_sum;
+    int flits;
+    double flat_sum;
+  };
+
+  PairStats( );
+
+  void Clear( );
+
+  void AddPacket( int pair, int plat, int nlat );
+  void AddFlit( int pair, int flat );
+
+  // entry of a pair, all zero if it has no samples
+  Entry const & Find( int pair ) const;
+
+private:
+
+  vector<int> _keys;
+  vector<Entry> _entries;
+  int _size;
+  Entry _empty;
+
+  int _Slot( int pair ) const;
+  Entry & _Insert( int pair );
+
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "buffer_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 BufferMonitor::BufferMonitor( int inputs, int classes ) 
 : _cycles(0), _inputs(inputs), _classes(classes) {
@@ -53,6 +54,18 @@ void BufferMonitor::read( int input, Flit const * f ) {
   _reads[ index(input, f->cl) ]++ ;
 }
 
+void BufferMonitor::Save( CheckpointWriter & w ) const {
+  w.Write( _cycles ) ;
+  w.Write( _reads ) ;
+  w.Write( _writes ) ;
+}
+
+void BufferMonitor::Load( CheckpointReader & r ) {
+  r.Read( _cycles ) ;
+  r.Read( _reads ) ;
+  r.Read( _writes ) ;
+}
+
 void BufferMonitor::display(ostream & os) const {
   for ( int i = 0 ; i < _inputs ; i++ ) {
     os << "[ " << i << " ] " ;
@@ -35,6 +35,9 @@ using namespace std;
 
 class Flit;
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class BufferMonitor {
   int  _cycles ;
   int  _inputs ;
@@ -47,6 +50,8 @@ public:
   void cycle() ;
   void write( int input, Flit const * f ) ;
   void read( int input, Flit const * f ) ;
+  void Save( CheckpointWriter & w ) const ;
+  void Load( CheckpointReader & r ) ;
   inline const vector<int> & GetReads() const {
     return _reads;
   }
@@ -35,6 +35,9 @@ using namespace std;
 
 class Flit;
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class SwitchMonitor {
   int  _cycles ;
   int  _inputs ;
@@ -58,6 +61,8 @@ public:
     return _classes;
   }
   void traversal( int input, int output, Flit const * f ) ;
+  void Save( CheckpointWriter & w ) const ;
+  void Load( CheckpointReader & r ) ;
   void display(ostream & os) const;
 } ;
 
@@ -0,0 +1,93 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "booksim.hpp"
+#include <iomanip>
+
+#include "profiler.hpp"
+
+Profiler::Profiler( vector<string> const & names )
+  : _names( names ), _ticks( names.size( ), 0 ), _cycles( 0 ), _flits( 0 )
+{
+  _start_time = chrono::steady_clock::now( );
+  _start_ticks = Ticks( );
+}
+
+double Profiler::Elapsed( ) const
+{
+  return chrono::duration<double>( chrono::steady_clock::now( ) -
+				   _start_time ).count( );
+}
+
+double Profiler::TicksPerSecond( ) const
+{
+  double const elapsed = Elapsed( );
+  return ( elapsed > 0.0 ) ? ( double )( Ticks( ) - _start_ticks ) / elapsed : 1.0;
+}
+
+void Profiler::Display( ostream & os, vector<string> const & stages,
+			vector<unsigned long long> const & stage_ticks ) const
+{
+  double const elapsed = Elapsed( );
+  double const rate = TicksPerSecond( );
+
+  os << "====== Simulator profile ======" << endl
+     << "Wall time = " << elapsed << " s" << endl
+     << "Simulated cycles = " << _cycles
+     << " (" << ( ( elapsed > 0.0 ) ? _cycles / elapsed : 0.0 ) << " per second)" << endl
+     << "Retired flits = " << _flits
+     << " (" << ( ( elapsed > 0.0 ) ? _flits / elapsed : 0.0 ) << " per second)" << endl;
+
+  ios_base::fmtflags const flags = os.flags( );
+  streamsize const precision = os.precision( );
+  os << fixed << setprecision( 3 );
+
+  double timed = 0.0;
+  for ( size_t i = 0; i < _names.size( ); ++i ) {
+    double const t = _ticks[i] / rate;
+    timed += t;
+    os << "  " << left << setw( 16 ) << _names[i] << right << setw( 10 ) << t
+       << " s " << setw( 6 ) << ( elapsed > 0.0 ? 100.0 * t / elapsed : 0.0 ) << "%" << endl;
+  }
+  os << "  " << left << setw( 16 ) << "other" << right << setw( 10 ) << ( elapsed - timed )
+     << " s " << setw( 6 ) << ( elapsed > 0.0 ? 100.0 * ( elapsed - timed ) / elapsed : 0.0 )
+     << "%" << endl;
+
+  if ( !stages.empty( ) ) {
+    os << "Router stages (summed over routers):" << endl;
+    for ( size_t i = 0; i < stages.size( ); ++i ) {
+      double const t = stage_ticks[i] / rate;
+      os << "  " << left << setw( 16 ) << stages[i] << right << setw( 10 ) << t
+	 << " s " << setw( 6 ) << ( elapsed > 0.0 ? 100.0 * t / elapsed : 0.0 ) << "%" << endl;
+    }
+  }
+
+  os.flags( flags );
+  os.precision( precision );
+}
@@ -0,0 +1,99 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+/*profiler.hpp
+ *
+ *Wall time spent in the phases of a simulation, for profile = 1. Phases
+ *are timed with the time stamp counter where available and with the
+ *steady clock otherwise; the counter is converted to seconds against
+ *the steady clock over the whole run. Lap() charges the time since the
+ *previous lap to one phase, so a sequence of phases costs one counter
+ *read each.
+ *
+ */
+
+#ifndef _PROFILER_HPP_
+#define _PROFILER_HPP_
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+using namespace std;
+
+class Profiler {
+
+  vector<string> _names;
+  vector<unsigned long long> _ticks;
+
+  long long _cycles;
+  long long _flits;
+
+  unsigned long long _start_ticks;
+  chrono::steady_clock::time_point _start_time;
+
+public:
+
+  Profiler( vector<string> const & names );
+
+  static inline unsigned long long Ticks( ) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc( );
+#else
+    return chrono::duration_cast<chrono::nanoseconds>
+      ( chrono::steady_clock::now( ).time_since_epoch( ) ).count( );
+#endif
+  }
+
+  inline unsigned long long Lap( int phase, unsigned long long since ) {
+    unsigned long long const now = Ticks( );
+    _ticks[phase] += now - since;
+    return now;
+  }
+  inline void Cycle( ) { ++_cycles; }
+  inline void Flits( int n ) { _flits += n; }
+
+  // seconds since construction, and counter ticks per second over the
+  // same interval
+  double Elapsed( ) const;
+  double TicksPerSecond( ) const;
+
+  // the phases, then the named stages with their ticks, which may add
+  // up to more than the wall time when they ran on several threads
+  void Display( ostream & os, vector<string> const & stages = vector<string>( ),
+		vector<unsigned long long> const & stage_ticks =
+		vector<unsigned long long>( ) ) const;
+
+};
+
+#endif
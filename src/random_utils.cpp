@@ -29,10 +29,13 @@
 #include <algorithm>
 #include <cassert>
 
-extern long ran_x[];
-extern double ran_u[];
+extern thread_local long ran_x[];
+extern thread_local double ran_u[];
 #define KK 100
 
+// the generators start from this seed until RandomSeed() is called
+thread_local long gRandomSeed = 314159;
+
 void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u ) {
   save_x.assign(ran_x, ran_x + KK);
   save_u.assign(ran_u, ran_u + KK);
@@ -44,3 +47,13 @@ void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> c
   assert(save_u.size() == KK);
   std::copy(save_u.begin(), save_u.end(), ran_u);
 }
+
+void SaveRandomStream( std::vector<long> & save_l, std::vector<double> & save_d ) {
+  ran_save(save_l);
+  ranf_save(save_d);
+}
+
+void RestoreRandomStream( std::vector<long> const & save_l, std::vector<double> const & save_d ) {
+  ran_restore(save_l);
+  ranf_restore(save_d);
+}
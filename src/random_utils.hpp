@@ -35,8 +35,17 @@ void   ran_start(long seed);
 long   ran_next( );
 void   ranf_start(long seed);
 double ranf_next( );
+// complete generator state, including numbers not yet handed out
+void   ran_save( std::vector<long> & state );
+void   ran_restore( std::vector<long> const & state );
+void   ranf_save( std::vector<double> & state );
+void   ranf_restore( std::vector<double> const & state );
+
+// seed last passed to RandomSeed() on this thread
+extern thread_local long gRandomSeed;
 
 inline void RandomSeed( long seed ) {
+  gRandomSeed = seed;
   ran_start( seed );
   ranf_start( seed );
 }
@@ -66,4 +75,9 @@ void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u )
 // Restores the generator state from previously saved values
 void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> const & save_u );
 
+// Saves and restores the exact position in the random sequence, unlike the
+// two functions above which only keep the seed state of the generator
+void SaveRandomStream( std::vector<long> & save_l, std::vector<double> & save_d );
+void RestoreRandomStream( std::vector<long> const & save_l, std::vector<double> const & save_d );
+
 #endif
@@ -21,7 +21,7 @@
 #define LL  37                     /* the short lag */
 #define mod_sum(x,y) (((x)+(y))-(int)((x)+(y)))   /* (x+y) mod 1.0 */
 
-double ran_u[KK];           /* the generator state */
+thread_local double ran_u[KK]; /* the generator state, per thread */
 
 #ifdef __STDC__
 void ranf_array(double aa[], int n)
@@ -42,9 +42,9 @@ void ranf_array(aa,n)    /* put n new random fractions in aa */
 /* after calling ranf_start, get new randoms by, e.g., "x=ranf_arr_next()" */
 
 #define QUALITY 1009 /* recommended quality level for high-res use */
-double ranf_arr_buf[QUALITY];
-double ranf_arr_dummy=-1.0, ranf_arr_started=-1.0;
-double *ranf_arr_ptr=&ranf_arr_dummy; /* the next random fraction, or -1 */
+thread_local double ranf_arr_buf[QUALITY];
+thread_local double ranf_arr_started=-1.0;
+thread_local double *ranf_arr_ptr=0; /* the next random fraction, or -1; 0 before ranf_start */
 
 #define TT  70   /* guaranteed separation between streams */
 #define is_odd(s) ((s)&1)
@@ -86,10 +86,10 @@ void ranf_start(seed)    /* do this before using ranf_array */
   ranf_arr_ptr=&ranf_arr_started;
 }
 
-#define ranf_arr_next() (*ranf_arr_ptr>=0? *ranf_arr_ptr++: ranf_arr_cycle())
+#define ranf_arr_next() (ranf_arr_ptr&&*ranf_arr_ptr>=0? *ranf_arr_ptr++: ranf_arr_cycle())
 double ranf_arr_cycle()
 {
-  if (ranf_arr_ptr==&ranf_arr_dummy)
+  if (!ranf_arr_ptr)
     ranf_start(314159L); /* the user forgot to initialize */
   ranf_array(ranf_arr_buf,QUALITY);
   ranf_arr_buf[KK]=-1;
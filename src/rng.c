@@ -22,7 +22,7 @@
 #define MM (1L<<30)                 /* the modulus */
 #define mod_diff(x,y) (((x)-(y))&(MM-1)) /* subtraction mod MM */
 
-long ran_x[KK];                    /* the generator state */
+thread_local long ran_x[KK];       /* the generator state, per thread */
 
 #ifdef __STDC__
 void ran_array(long aa[],int n)
@@ -43,9 +43,9 @@ void ran_array(aa,n)    /* put n new random numbers in aa */
 /* after calling ran_start, get new randoms by, e.g., "x=ran_arr_next()" */
 
 #define QUALITY 1009 /* recommended quality level for high-res use */
-long ran_arr_buf[QUALITY];
-long ran_arr_dummy=-1, ran_arr_started=-1;
-long *ran_arr_ptr=&ran_arr_dummy; /* the next random number, or -1 */
+thread_local long ran_arr_buf[QUALITY];
+thread_local long ran_arr_started=-1;
+thread_local long *ran_arr_ptr=0; /* the next random number, or -1; 0 before ran_start */
 
 #define TT  70   /* guaranteed separation between streams */
 #define is_odd(x)  ((x)&1)          /* units bit of x */
@@ -83,10 +83,10 @@ void ran_start(seed)    /* do this before using ran_array */
   ran_arr_ptr=&ran_arr_started;
 }
 
-#define ran_arr_next() (*ran_arr_ptr>=0? *ran_arr_ptr++: ran_arr_cycle())
+#define ran_arr_next() (ran_arr_ptr&&*ran_arr_ptr>=0? *ran_arr_ptr++: ran_arr_cycle())
 long ran_arr_cycle()
 {
-  if (ran_arr_ptr==&ran_arr_dummy)
+  if (!ran_arr_ptr)
     ran_start(314159L); /* the user forgot to initialize */
   ran_array(ran_arr_buf,QUALITY);
   ran_arr_buf[KK]=-1;
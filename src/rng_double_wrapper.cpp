@@ -25,6 +25,10 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 #define main rng_double_main
 #include "rng-double.c"
 
@@ -32,3 +36,33 @@ double ranf_next( )
 {
   return ranf_arr_next( );
 }
+
+// lags, buffer, then the read position (-2: not started, -1: just seeded)
+void ranf_save( std::vector<double> & state )
+{
+  state.assign(ran_u, ran_u + KK);
+  state.insert(state.end(), ranf_arr_buf, ranf_arr_buf + QUALITY);
+  if(!ranf_arr_ptr) {
+    state.push_back(-2);
+  } else if(ranf_arr_ptr == &ranf_arr_started) {
+    state.push_back(-1);
+  } else {
+    state.push_back(ranf_arr_ptr - ranf_arr_buf);
+  }
+}
+
+void ranf_restore( std::vector<double> const & state )
+{
+  assert(state.size() == KK + QUALITY + 1);
+  std::copy(state.begin(), state.begin() + KK, ran_u);
+  std::copy(state.begin() + KK, state.begin() + KK + QUALITY, ranf_arr_buf);
+  int const pos = (int)state.back();
+  if(pos == -2) {
+    ranf_arr_ptr = 0;
+  } else if(pos == -1) {
+    ranf_arr_ptr = &ranf_arr_started;
+  } else {
+    assert((pos >= 0) && (pos <= KK));
+    ranf_arr_ptr = ranf_arr_buf + pos;
+  }
+}
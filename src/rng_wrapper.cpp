@@ -25,6 +25,10 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 #define main rng_main
 #include "rng.c"
 
@@ -32,3 +36,33 @@ long ran_next( )
 {
   return ran_arr_next( );
 }
+
+// lags, buffer, then the read position (-2: not started, -1: just seeded)
+void ran_save( std::vector<long> & state )
+{
+  state.assign(ran_x, ran_x + KK);
+  state.insert(state.end(), ran_arr_buf, ran_arr_buf + QUALITY);
+  if(!ran_arr_ptr) {
+    state.push_back(-2);
+  } else if(ran_arr_ptr == &ran_arr_started) {
+    state.push_back(-1);
+  } else {
+    state.push_back(ran_arr_ptr - ran_arr_buf);
+  }
+}
+
+void ran_restore( std::vector<long> const & state )
+{
+  assert(state.size() == KK + QUALITY + 1);
+  std::copy(state.begin(), state.begin() + KK, ran_x);
+  std::copy(state.begin() + KK, state.begin() + KK + QUALITY, ran_arr_buf);
+  long const pos = state.back();
+  if(pos == -2) {
+    ran_arr_ptr = 0;
+  } else if(pos == -1) {
+    ran_arr_ptr = &ran_arr_started;
+  } else {
+    assert((pos >= 0) && (pos <= KK));
+    ran_arr_ptr = ran_arr_buf + pos;
+  }
+}
@@ -470,8 +470,9 @@ void EventRouter::_ArrivalArb( int output )
     c = _out_cred_buffer[output].front( );
     _out_cred_buffer[output].pop( );
     
-    assert( c->vc.size() == 1 );
-    int vc = *c->vc.begin();
+    int vc = c->FirstVC();
+    assert( vc >= 0 );
+    assert( ( c->NumVCs() == 1 ) && ( c->Count( vc ) == 1 ) );
 
     EventNextVCState::eNextVCState state = 
       _output_state[output]->GetState( vc );
@@ -671,7 +672,7 @@ void EventRouter::_TransportArb( int input )
     }
 
     c = Credit::New( );
-    c->vc.insert(f->vc);
+    c->AddVC(f->vc);
     c->head          = f->head;
     c->tail          = f->tail;
     c->id            = f->id;
@@ -46,10 +46,19 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "checkpoint.hpp"
+
+const char * const IQRouter::STAGE[] = {"route",
+					"vc_alloc",
+					"sw_hold",
+					"sw_alloc",
+					"switch",
+					"update"};
 
 IQRouter::IQRouter( Configuration const & config, Module *parent, 
 		    string const & name, int id, int inputs, int outputs,
-        vector<int> const & input_bandwidths, vector<int> const & output_bandwidths )
+        vector<int> const & input_bandwidths, vector<int> const & output_bandwidths,
+        vector<int> const & input_vc_buf_sizes, vector<int> const & output_vc_buf_sizes )
 : Router( config, parent, name, id, inputs, outputs, input_bandwidths, output_bandwidths ), _active(false)
 {
   _vcs         = config.GetInt( "num_vcs" );
@@ -113,7 +122,14 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
     // bandwidth = !_input_bandwidths.empty() ? _input_bandwidths[i] : 1;
     ostringstream module_name;
     module_name << "buf_" << i;
-    _buf[i] = new Buffer(config, _outputs, this, module_name.str( ) );
+    if((i < (int)input_vc_buf_sizes.size()) && (input_vc_buf_sizes[i] > 0)) {
+      Configuration port_config(config);
+      port_config.Assign("buf_size", -1);
+      port_config.Assign("vc_buf_size", input_vc_buf_sizes[i]);
+      _buf[i] = new Buffer(port_config, _outputs, this, module_name.str( ) );
+    } else {
+      _buf[i] = new Buffer(config, _outputs, this, module_name.str( ) );
+    }
     module_name.str("");
   }
 
@@ -122,7 +138,14 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   for (int j = 0; j < _outputs; ++j) {
     ostringstream module_name;
     module_name << "next_vc_o" << j;
-    _next_buf[j] = new BufferState( config, this, module_name.str( ) );
+    if((j < (int)output_vc_buf_sizes.size()) && (output_vc_buf_sizes[j] > 0)) {
+      Configuration port_config(config);
+      port_config.Assign("buf_size", -1);
+      port_config.Assign("vc_buf_size", output_vc_buf_sizes[j]);
+      _next_buf[j] = new BufferState( port_config, this, module_name.str( ) );
+    } else {
+      _next_buf[j] = new BufferState( config, this, module_name.str( ) );
+    }
     module_name.str("");
   }
 
@@ -185,6 +208,11 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   _noq_next_vc_start.resize(_inputs, vector<int>(_vcs, -1));
   _noq_next_vc_end.resize(_inputs, vector<int>(_vcs, -1));
 
+  _mcast_copies.resize(_inputs*_vcs);
+
+  _profile = (config.GetInt("profile") > 0);
+  _stage_ticks.resize(stage_max + 1, 0);
+
   // Output queues
   _output_buffer_size = config.GetInt("output_buffer_size");
   _output_buffer.resize(_outputs); 
@@ -199,13 +227,13 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   _bufferMonitor = new BufferMonitor(inputs, _classes);
   _switchMonitor = new SwitchMonitor(inputs, outputs, _classes);
 
-#ifdef TRACK_FLOWS
-  for(int c = 0; c < _classes; ++c) {
-    _stored_flits[c].resize(_inputs, 0);
-    _active_packets[c].resize(_inputs, 0);
+  if(_track_flows) {
+    for(int c = 0; c < _classes; ++c) {
+      _stored_flits[c].resize(_inputs, 0);
+      _active_packets[c].resize(_inputs, 0);
+    }
+    _outstanding_classes.resize(_outputs, vector<queue<int> >(_vcs));
   }
-  _outstanding_classes.resize(_outputs, vector<queue<int> >(_vcs));
-#endif
 }
 
 IQRouter::~IQRouter( )
@@ -260,24 +288,31 @@ void IQRouter::_InternalStep( )
   _InputQueuing( );
   bool activity = !_proc_credits.empty();
 
+  unsigned long long t = _profile ? Profiler::Ticks( ) : 0;
+
   if(!_route_vcs.empty())
     _RouteEvaluate( );
+  _Lap(stage_route, t);
   if(_vc_allocator) {
     _vc_allocator->Clear();
     if(!_vc_alloc_vcs.empty())
       _VCAllocEvaluate( );
   }
+  _Lap(stage_vc_alloc, t);
   if(_hold_switch_for_packet) {
     if(!_sw_hold_vcs.empty())
       _SWHoldEvaluate( );
   }
+  _Lap(stage_sw_hold, t);
   _sw_allocator->Clear();
   if(_spec_sw_allocator)
     _spec_sw_allocator->Clear();
   if(!_sw_alloc_vcs.empty())
     _SWAllocEvaluate( );
+  _Lap(stage_sw_alloc, t);
   if(!_crossbar_flits.empty())
     _SwitchEvaluate( );
+  _Lap(stage_switch, t);
 
   if(!_route_vcs.empty()) {
     _RouteUpdate( );
@@ -301,6 +336,7 @@ void IQRouter::_InternalStep( )
     _SwitchUpdate( );
     activity = activity || !_crossbar_flits.empty();
   }
+  _Lap(stage_update, t);
 
   _active = activity;
 
@@ -331,9 +367,9 @@ bool IQRouter::_ReceiveFlits( )
       Flit * const f = channel->Receive();
       if(f) {
 
-#ifdef TRACK_FLOWS
-        ++_received_flits[f->cl][input];
-#endif
+        if(_track_flows) {
+          ++_received_flits[f->cl][input];
+        }
 
         if(f->watch) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -401,10 +437,10 @@ void IQRouter::_InputQueuing( )
     }
     cur_buf->AddFlit(vc, f);
 
-#ifdef TRACK_FLOWS
-    ++_stored_flits[f->cl][input];
-    if(f->head) ++_active_packets[f->cl][input];
-#endif
+    if(_track_flows) {
+      ++_stored_flits[f->cl][input];
+      if(f->head) ++_active_packets[f->cl][input];
+    }
 
     _bufferMonitor->write(input, f) ;
 
@@ -468,16 +504,17 @@ void IQRouter::_InputQueuing( )
     
     BufferState * const dest_buf = _next_buf[output];
     
-#ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-      int const vc = *iter;
-      assert(!_outstanding_classes[output][vc].empty());
-      int cl = _outstanding_classes[output][vc].front();
-      _outstanding_classes[output][vc].pop();
-      assert(_outstanding_credits[cl][output] > 0);
-      --_outstanding_credits[cl][output];
+    if(_track_flows) {
+      for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
+	for(int slot = 0; slot < c->Count(vc); ++slot) {
+	  assert(!_outstanding_classes[output][vc].empty());
+	  int cl = _outstanding_classes[output][vc].front();
+	  _outstanding_classes[output][vc].pop();
+	  assert(_outstanding_credits[cl][output] > 0);
+	  --_outstanding_credits[cl][output];
+	}
+      }
     }
-#endif
 
     dest_buf->ProcessCredit(c);
     c->Free();
@@ -625,16 +662,14 @@ void IQRouter::_VCAllocEvaluate( )
     assert(route_set);
 
     int const out_priority = cur_buf->GetPriority(vc);
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
-
     bool elig = false;
     bool cred = false;
     bool reserved = false;
 
-    assert(!_noq || (setlist.size() == 1));
+    assert(!_noq || (route_set->Size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
-	iset != setlist.end();
+    for(OutputSet::const_iterator iset = route_set->begin();
+	iset != route_set->end();
 	++iset) {
 
       int const out_port = iset->output_port;
@@ -941,15 +976,15 @@ void IQRouter::_VCAllocUpdate( )
 		   << "  No output VC allocated." << endl;
       }
 
-#ifdef TRACK_STALLS
-      assert((output_and_vc == STALL_BUFFER_BUSY) ||
-	     (output_and_vc == STALL_BUFFER_CONFLICT));
-      if(output_and_vc == STALL_BUFFER_BUSY) {
-	++_buffer_busy_stalls[f->cl];
-      } else if(output_and_vc == STALL_BUFFER_CONFLICT) {
-	++_buffer_conflict_stalls[f->cl];
+      if(_track_stalls) {
+	assert((output_and_vc == STALL_BUFFER_BUSY) ||
+	       (output_and_vc == STALL_BUFFER_CONFLICT));
+	if(output_and_vc == STALL_BUFFER_BUSY) {
+	  ++_buffer_busy_stalls[f->cl];
+	} else if(output_and_vc == STALL_BUFFER_CONFLICT) {
+	  ++_buffer_conflict_stalls[f->cl];
+	}
       }
-#endif
 
       _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
     }
@@ -1103,10 +1138,12 @@ void IQRouter::_SWHoldUpdate( )
       
       cur_buf->RemoveFlit(vc);
 
-#ifdef TRACK_FLOWS
-      --_stored_flits[f->cl][input];
-      if(f->tail) --_active_packets[f->cl][input];
-#endif
+      if(_track_flows) {
+	--_stored_flits[f->cl][input];
+	if(f->tail) --_active_packets[f->cl][input];
+      }
+
+      bool const replicated = _ReplicateFlit(input, vc, output, f);
 
       _bufferMonitor->read(input, f) ;
       
@@ -1148,19 +1185,25 @@ void IQRouter::_SWHoldUpdate( )
 	}
       }
 
-#ifdef TRACK_FLOWS
-      ++_outstanding_credits[f->cl][output];
-      _outstanding_classes[output][f->vc].push(f->cl);
-#endif
+      if(_track_flows) {
+	++_outstanding_credits[f->cl][output];
+	_outstanding_classes[output][f->vc].push(f->cl);
+      }
 
       dest_buf->SendingFlit(f);
 
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
       
-      if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!replicated) {
+	if(_out_queue_credits.count(input) == 0) {
+	  _out_queue_credits.insert(make_pair(input, Credit::New()));
+	}
+	_out_queue_credits.find(input)->second->AddVC(vc);
+      }
+
+      if(f->tail) {
+	_RequeueCopies(input, vc);
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
       
       if(cur_buf->Empty(vc)) {
 	if(f->watch) {
@@ -1431,12 +1474,10 @@ void IQRouter::_SWAllocEvaluate( )
     OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
     assert(route_set);
     
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
-    
-    assert(!_noq || (setlist.size() == 1));
+    assert(!_noq || (route_set->Size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
-	iset != setlist.end();
+    for(OutputSet::const_iterator iset = route_set->begin();
+	iset != route_set->end();
 	++iset) {
       
       int const dest_output = iset->output_port;
@@ -1775,16 +1816,14 @@ void IQRouter::_SWAllocEvaluate( )
 	  OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
 	  assert(route_set);
 
-	  set<OutputSet::sSetElement> const setlist = route_set->GetSet();
-
 	  bool busy = true;
 	  bool full = true;
 	  bool reserved = false;
 
-	  assert(!_noq || (setlist.size() == 1));
+	  assert(!_noq || (route_set->Size() == 1));
 
-	  for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
-	      iset != setlist.end();
+	  for(OutputSet::const_iterator iset = route_set->begin();
+	      iset != route_set->end();
 	      ++iset) {
 	    if(iset->output_port == output) {
 
@@ -1930,12 +1969,11 @@ void IQRouter::_SWAllocUpdate( )
 	int match_prio = numeric_limits<int>::min();
 
 	const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-	set<OutputSet::sSetElement> const setlist = route_set->GetSet();
 	
-	assert(!_noq || (setlist.size() == 1));
+	assert(!_noq || (route_set->Size() == 1));
 	
-	for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
-	    iset != setlist.end();
+	for(OutputSet::const_iterator iset = route_set->begin();
+	    iset != route_set->end();
 	    ++iset) {
 	  if(iset->output_port == output) {
 
@@ -2013,10 +2051,12 @@ void IQRouter::_SWAllocUpdate( )
 
       cur_buf->RemoveFlit(vc);
 
-#ifdef TRACK_FLOWS
-      --_stored_flits[f->cl][input];
-      if(f->tail) --_active_packets[f->cl][input];
-#endif
+      if(_track_flows) {
+	--_stored_flits[f->cl][input];
+	if(f->tail) --_active_packets[f->cl][input];
+      }
+
+      bool const replicated = _ReplicateFlit(input, vc, output, f);
 
       _bufferMonitor->read(input, f) ;
 
@@ -2058,19 +2098,25 @@ void IQRouter::_SWAllocUpdate( )
 	}
       }
 
-#ifdef TRACK_FLOWS
-      ++_outstanding_credits[f->cl][output];
-      _outstanding_classes[output][f->vc].push(f->cl);
-#endif
+      if(_track_flows) {
+	++_outstanding_credits[f->cl][output];
+	_outstanding_classes[output][f->vc].push(f->cl);
+      }
 
       dest_buf->SendingFlit(f);
 
       _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
 
-      if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!replicated) {
+	if(_out_queue_credits.count(input) == 0) {
+	  _out_queue_credits.insert(make_pair(input, Credit::New()));
+	}
+	_out_queue_credits.find(input)->second->AddVC(vc);
+      }
+
+      if(f->tail) {
+	_RequeueCopies(input, vc);
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
 
       if(cur_buf->Empty(vc)) {
 	if(f->tail) {
@@ -2135,25 +2181,25 @@ void IQRouter::_SWAllocUpdate( )
 		   << "  No output port allocated." << endl;
       }
 
-#ifdef TRACK_STALLS
-      assert((expanded_output == -1) || // for stalls that are accounted for in VC allocation path
-	     (expanded_output == STALL_BUFFER_BUSY) ||
-	     (expanded_output == STALL_BUFFER_CONFLICT) ||
-	     (expanded_output == STALL_BUFFER_FULL) ||
-	     (expanded_output == STALL_BUFFER_RESERVED) ||
-	     (expanded_output == STALL_CROSSBAR_CONFLICT));
-      if(expanded_output == STALL_BUFFER_BUSY) {
-	++_buffer_busy_stalls[f->cl];
-      } else if(expanded_output == STALL_BUFFER_CONFLICT) {
-	++_buffer_conflict_stalls[f->cl];
-      } else if(expanded_output == STALL_BUFFER_FULL) {
-	++_buffer_full_stalls[f->cl];
-      } else if(expanded_output == STALL_BUFFER_RESERVED) {
-	++_buffer_reserved_stalls[f->cl];
-      } else if(expanded_output == STALL_CROSSBAR_CONFLICT) {
-	++_crossbar_conflict_stalls[f->cl];
+      if(_track_stalls) {
+	assert((expanded_output == -1) || // for stalls that are accounted for in VC allocation path
+	       (expanded_output == STALL_BUFFER_BUSY) ||
+	       (expanded_output == STALL_BUFFER_CONFLICT) ||
+	       (expanded_output == STALL_BUFFER_FULL) ||
+	       (expanded_output == STALL_BUFFER_RESERVED) ||
+	       (expanded_output == STALL_CROSSBAR_CONFLICT));
+	if(expanded_output == STALL_BUFFER_BUSY) {
+	  ++_buffer_busy_stalls[f->cl];
+	} else if(expanded_output == STALL_BUFFER_CONFLICT) {
+	  ++_buffer_conflict_stalls[f->cl];
+	} else if(expanded_output == STALL_BUFFER_FULL) {
+	  ++_buffer_full_stalls[f->cl];
+	} else if(expanded_output == STALL_BUFFER_RESERVED) {
+	  ++_buffer_reserved_stalls[f->cl];
+	} else if(expanded_output == STALL_CROSSBAR_CONFLICT) {
+	  ++_crossbar_conflict_stalls[f->cl];
+	}
       }
-#endif
 
       _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
     }
@@ -2259,7 +2305,7 @@ void IQRouter::_OutputQueuing( )
 
     Credit * const c = iter->second;
     assert(c);
-    assert(!c->vc.empty());
+    assert(!c->Empty());
 
     _credit_buffer[input].push(c);
   }
@@ -2281,9 +2327,9 @@ void IQRouter::_SendFlits( )
         assert(f);
         _output_buffer[output].pop( );
 
-  #ifdef TRACK_FLOWS
-        ++_sent_flits[f->cl][output];
-  #endif
+        if(_track_flows) {
+          ++_sent_flits[f->cl][output];
+        }
 
         if(f->watch)
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
@@ -2316,6 +2362,88 @@ void IQRouter::_SendCredits( )
 // misc.
 //------------------------------------------------------------------------------
 
+void IQRouter::Save( CheckpointWriter & w ) const
+{
+  _SaveState( w );
+  w.Write( _vcs );
+  w.Write( _active );
+  w.Write( _in_queue_flits );
+  w.Write( _proc_credits );
+  w.Write( _route_vcs );
+  w.Write( _vc_alloc_vcs );
+  w.Write( _sw_hold_vcs );
+  w.Write( _sw_alloc_vcs );
+  w.Write( _crossbar_flits );
+  w.Write( _out_queue_credits );
+  for ( int i = 0; i < _inputs; ++i ) {
+    _buf[i]->Save( w );
+  }
+  for ( int o = 0; o < _outputs; ++o ) {
+    _next_buf[o]->Save( w );
+  }
+  _vc_allocator->Save( w );
+  _sw_allocator->Save( w );
+  if ( _spec_sw_allocator ) {
+    _spec_sw_allocator->Save( w );
+  }
+  w.Write( _vc_rr_offset );
+  w.Write( _sw_rr_offset );
+  w.Write( _output_buffer );
+  w.Write( _credit_buffer );
+  w.Write( _switch_hold_in );
+  w.Write( _switch_hold_out );
+  w.Write( _switch_hold_vc );
+  w.Write( _noq_next_output_port );
+  w.Write( _noq_next_vc_start );
+  w.Write( _noq_next_vc_end );
+  if(_track_flows) {
+    w.Write( _outstanding_classes );
+  }
+  _switchMonitor->Save( w );
+  _bufferMonitor->Save( w );
+}
+
+void IQRouter::Load( CheckpointReader & r )
+{
+  _LoadState( r );
+  r.Expect( _vcs, "number of VCs" );
+  r.Read( _active );
+  r.Read( _in_queue_flits );
+  r.Read( _proc_credits );
+  r.Read( _route_vcs );
+  r.Read( _vc_alloc_vcs );
+  r.Read( _sw_hold_vcs );
+  r.Read( _sw_alloc_vcs );
+  r.Read( _crossbar_flits );
+  r.Read( _out_queue_credits );
+  for ( int i = 0; i < _inputs; ++i ) {
+    _buf[i]->Load( r );
+  }
+  for ( int o = 0; o < _outputs; ++o ) {
+    _next_buf[o]->Load( r );
+  }
+  _vc_allocator->Load( r );
+  _sw_allocator->Load( r );
+  if ( _spec_sw_allocator ) {
+    _spec_sw_allocator->Load( r );
+  }
+  r.Read( _vc_rr_offset );
+  r.Read( _sw_rr_offset );
+  r.Read( _output_buffer );
+  r.Read( _credit_buffer );
+  r.Read( _switch_hold_in );
+  r.Read( _switch_hold_out );
+  r.Read( _switch_hold_vc );
+  r.Read( _noq_next_output_port );
+  r.Read( _noq_next_vc_start );
+  r.Read( _noq_next_vc_end );
+  if(_track_flows) {
+    r.Read( _outstanding_classes );
+  }
+  _switchMonitor->Load( r );
+  _bufferMonitor->Load( r );
+}
+
 void IQRouter::Display( ostream & os ) const
 {
   for ( int input = 0; input < _inputs; ++input ) {
@@ -2335,7 +2463,6 @@ int IQRouter::GetBufferOccupancy(int i) const {
   return _buf[i]->GetOccupancy();
 }
 
-#ifdef TRACK_BUFFERS
 int IQRouter::GetUsedCreditForClass(int output, int cl) const
 {
   assert((output >= 0) && (output < _outputs));
@@ -2348,7 +2475,6 @@ int IQRouter::GetBufferOccupancyForClass(int input, int cl) const
   assert((input >= 0) && (input < _inputs));
   return _buf[input]->GetOccupancyForClass(cl);
 }
-#endif
 
 vector<int> IQRouter::UsedCredits() const
 {
@@ -2388,18 +2514,16 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
   assert(f);
   assert(f->vc == vc);
   assert(f->head);
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
-  assert(sl.size() == 1);
-  int out_port = sl.begin()->output_port;
+  assert(f->la_route_set.Size() == 1);
+  int out_port = f->la_route_set.begin()->output_port;
   const FlitChannel * channel = _output_channels[out_port];
   const Router * router = channel->GetSink();
   if(router) {
     int in_channel = channel->GetSinkPort();
     OutputSet nos;
     _rf(router, f, in_channel, &nos, false);
-    sl = nos.GetSet();
-    assert(sl.size() == 1);
-    OutputSet::sSetElement const & se = *sl.begin();
+    assert(nos.Size() == 1);
+    OutputSet::sSetElement const & se = *nos.begin();
     int next_output_port = se.output_port;
     assert(next_output_port >= 0);
     assert(_noq_next_output_port[input][vc] < 0);
@@ -2421,3 +2545,117 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
     }
   }
 }
+
+// same output ports and VC ranges, in the same order
+static bool SameRoute(OutputSet const & a, OutputSet const & b)
+{
+  if(a.Size() != b.Size()) {
+    return false;
+  }
+  for(OutputSet::const_iterator i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+    if((i->output_port != j->output_port) || (i->vc_start != j->vc_start) ||
+       (i->vc_end != j->vc_end)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A multicast head takes the destinations routed through its output with
+// it and leaves a copy for the others in the VC; the packet's other flits
+// are copied as they leave, and the copies go back to the buffer once the
+// tail is gone. Returns whether a copy was kept, in which case the flit's
+// buffer slot stays taken and no credit is returned.
+bool IQRouter::_ReplicateFlit(int input, int vc, int output, Flit * f)
+{
+  vector<Flit *> & copies = _mcast_copies[input*_vcs+vc];
+  vector<int> rest;
+
+  if(f->head) {
+    assert(copies.empty());
+    if(f->mcast.size() <= 1) {
+      return false;
+    }
+    vector<int> branch;
+    int const dest = f->dest;
+    int const intm = f->intm;
+    int const ph = f->ph;
+    // the members are compared with the head's own destination routed
+    // the same way right now rather than with output: an adaptive routing
+    // function may have chosen output on other terms (e.g. a detour, which
+    // already changed f->ph), so only members that route exactly like the
+    // head, including the state they leave in the flit, follow it
+    OutputSet head_route;
+    _rf(this, f, input, &head_route, false);
+    int const head_intm = f->intm;
+    int const head_ph = f->ph;
+    bool const head_on_output = !head_route.OutputEmpty(output);
+    OutputSet route;
+    for(vector<int>::const_iterator d = f->mcast.begin(); d != f->mcast.end(); ++d) {
+      bool follows = (*d == dest);
+      if(!follows) {
+	f->dest = *d;
+	f->intm = intm;
+	f->ph = ph;
+	route.Clear();
+	_rf(this, f, input, &route, false);
+	follows = (f->intm == head_intm) && (f->ph == head_ph) &&
+	  (head_on_output ? !route.OutputEmpty(output) :
+	   SameRoute(route, head_route));
+      }
+      if(follows) {
+	branch.push_back(*d);
+      } else {
+	rest.push_back(*d);
+      }
+    }
+    f->dest = dest;
+    f->intm = intm;
+    f->ph = ph;
+    if(rest.empty()) {
+      return false;
+    }
+    assert(!branch.empty() && (branch.front() == dest));
+    f->mcast.swap(branch);
+
+    if(f->watch) {
+      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+		 << "Replicating flit " << f->id
+		 << " at input " << input
+		 << " for " << rest.size() << " destinations not on output "
+		 << output << "." << endl;
+    }
+  } else if(copies.empty()) {
+    return false;
+  }
+
+  Flit * const c = Flit::New();
+  *c = *f;
+  if(c->head) {
+    c->mcast.swap(rest);
+    c->dest = c->mcast.front();
+    if(!_routing_delay) {
+      c->la_route_set.Clear();
+      _rf(this, c, input, &c->la_route_set, false);
+    }
+  }
+  copies.push_back(c);
+  return true;
+}
+
+void IQRouter::_RequeueCopies(int input, int vc)
+{
+  vector<Flit *> & copies = _mcast_copies[input*_vcs+vc];
+  if(copies.empty()) {
+    return;
+  }
+  assert(copies.front()->head && copies.back()->tail);
+  _buf[input]->RequeueFlits(vc, copies);
+  if(_track_flows) {
+    for(size_t i = 0; i < copies.size(); ++i) {
+      ++_stored_flits[copies[i]->cl][input];
+    }
+    ++_active_packets[copies.front()->cl][input];
+  }
+  copies.clear();
+}
@@ -36,6 +36,7 @@
 
 #include "router.hpp"
 #include "routefunc.hpp"
+#include "profiler.hpp"
 
 using namespace std;
 
@@ -50,6 +51,14 @@ class BufferMonitor;
 
 class IQRouter : public Router {
 
+public:
+  enum eStage { stage_min = 0, stage_route = stage_min, stage_vc_alloc,
+		stage_sw_hold, stage_sw_alloc, stage_switch, stage_update,
+		stage_max = stage_update };
+  static const char * const STAGE[];
+
+private:
+
   int _vcs;
 
   bool _vc_busy_when_full;
@@ -108,9 +117,24 @@ class IQRouter : public Router {
   vector<vector<int> > _noq_next_vc_start;
   vector<vector<int> > _noq_next_vc_end;
 
-#ifdef TRACK_FLOWS
+  // copies of the multicast packet leaving each input VC for the
+  // destinations off its current branch; they keep the buffer slots (and
+  // the upstream credits) of the packet until the last branch leaves
+  vector<vector<Flit *> > _mcast_copies;
+
   vector<vector<queue<int> > > _outstanding_classes;
-#endif
+
+  // counter ticks spent in each pipeline stage, with profile = 1
+  bool _profile;
+  vector<unsigned long long> _stage_ticks;
+
+  inline void _Lap( eStage stage, unsigned long long & t ) {
+    if ( _profile ) {
+      unsigned long long const now = Profiler::Ticks( );
+      _stage_ticks[stage] += now - t;
+      t = now;
+    }
+  }
 
   bool _ReceiveFlits( );
   bool _ReceiveCredits( );
@@ -140,6 +164,9 @@ class IQRouter : public Router {
   
   void _UpdateNOQ(int input, int vc, Flit const * f);
 
+  bool _ReplicateFlit(int input, int vc, int output, Flit * f);
+  void _RequeueCopies(int input, int vc);
+
   // ----------------------------------------
   //
   //   Router Power Modellingyes
@@ -153,7 +180,8 @@ public:
 
   IQRouter( Configuration const & config,
 	    Module *parent, string const & name, int id, int inputs, int outputs,
-      vector<int> const & input_bandwidths = {}, vector<int> const & output_bandwidths = {} );
+      vector<int> const & input_bandwidths = {}, vector<int> const & output_bandwidths = {},
+      vector<int> const & input_vc_buf_sizes = {}, vector<int> const & output_vc_buf_sizes = {} );
   
   virtual ~IQRouter( );
   
@@ -164,13 +192,14 @@ public:
   
   void Display( ostream & os = cout ) const;
 
+  virtual void Save( CheckpointWriter & w ) const;
+  virtual void Load( CheckpointReader & r );
+
   virtual int GetUsedCredit(int o) const;
   virtual int GetBufferOccupancy(int i) const;
 
-#ifdef TRACK_BUFFERS
   virtual int GetUsedCreditForClass(int output, int cl) const;
   virtual int GetBufferOccupancyForClass(int input, int cl) const;
-#endif
 
   virtual vector<int> UsedCredits() const;
   virtual vector<int> FreeCredits() const;
@@ -179,6 +208,8 @@ public:
   SwitchMonitor const * const GetSwitchMonitor() const {return _switchMonitor;}
   BufferMonitor const * const GetBufferMonitor() const {return _bufferMonitor;}
 
+  inline vector<unsigned long long> const & GetStageTicks() const {return _stage_ticks;}
+
 };
 
 #endif
@@ -43,6 +43,7 @@
 #include <cassert>
 #include <vector>
 #include "router.hpp"
+#include "checkpoint.hpp"
 
 //////////////////Sub router types//////////////////////
 #include "iq_router.hpp"
@@ -69,6 +70,8 @@ TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
   _output_speedup   = config.GetInt( "output_speedup" );
   _internal_speedup = config.GetFloat( "internal_speedup" );
   _classes          = config.GetInt( "classes" );
+  _track_flows      = ( config.GetInt( "track_flows" ) > 0 );
+  _track_stalls     = ( config.GetInt( "track_stalls" ) > 0 );
 
   _input_bandwidths = input_bandwidths;
   if (_input_bandwidths.empty()) {
@@ -82,21 +85,21 @@ TimedModule( parent, name ), _id( id ), _inputs( inputs ), _outputs( outputs ),
   }
   _output_bandwidths.resize(_outputs, _output_bandwidths.back());
 
-#ifdef TRACK_FLOWS
-  _received_flits.resize(_classes, vector<int>(_inputs, 0));
-  _stored_flits.resize(_classes);
-  _sent_flits.resize(_classes, vector<int>(_outputs, 0));
-  _active_packets.resize(_classes);
-  _outstanding_credits.resize(_classes, vector<int>(_outputs, 0));
-#endif
-
-#ifdef TRACK_STALLS
-  _buffer_busy_stalls.resize(_classes, 0);
-  _buffer_conflict_stalls.resize(_classes, 0);
-  _buffer_full_stalls.resize(_classes, 0);
-  _buffer_reserved_stalls.resize(_classes, 0);
-  _crossbar_conflict_stalls.resize(_classes, 0);
-#endif
+  if(_track_flows) {
+    _received_flits.resize(_classes, vector<int>(_inputs, 0));
+    _stored_flits.resize(_classes);
+    _sent_flits.resize(_classes, vector<int>(_outputs, 0));
+    _active_packets.resize(_classes);
+    _outstanding_credits.resize(_classes, vector<int>(_outputs, 0));
+  }
+
+  if(_track_stalls) {
+    _buffer_busy_stalls.resize(_classes, 0);
+    _buffer_conflict_stalls.resize(_classes, 0);
+    _buffer_full_stalls.resize(_classes, 0);
+    _buffer_reserved_stalls.resize(_classes, 0);
+    _crossbar_conflict_stalls.resize(_classes, 0);
+  }
 
 }
 
@@ -124,6 +127,58 @@ void Router::Evaluate( )
   }
 }
 
+void Router::Save( CheckpointWriter & w ) const
+{
+  Error( "Checkpoints are not supported by this router type." );
+}
+
+void Router::Load( CheckpointReader & r )
+{
+  Error( "Checkpoints are not supported by this router type." );
+}
+
+void Router::_SaveState( CheckpointWriter & w ) const
+{
+  w.Write( _inputs );
+  w.Write( _outputs );
+  w.Write( _partial_internal_cycles );
+  if(_track_flows) {
+    w.Write( _received_flits );
+    w.Write( _stored_flits );
+    w.Write( _sent_flits );
+    w.Write( _outstanding_credits );
+    w.Write( _active_packets );
+  }
+  if(_track_stalls) {
+    w.Write( _buffer_busy_stalls );
+    w.Write( _buffer_conflict_stalls );
+    w.Write( _buffer_full_stalls );
+    w.Write( _buffer_reserved_stalls );
+    w.Write( _crossbar_conflict_stalls );
+  }
+}
+
+void Router::_LoadState( CheckpointReader & r )
+{
+  r.Expect( _inputs, "router inputs" );
+  r.Expect( _outputs, "router outputs" );
+  r.Read( _partial_internal_cycles );
+  if(_track_flows) {
+    r.Read( _received_flits );
+    r.Read( _stored_flits );
+    r.Read( _sent_flits );
+    r.Read( _outstanding_credits );
+    r.Read( _active_packets );
+  }
+  if(_track_stalls) {
+    r.Read( _buffer_busy_stalls );
+    r.Read( _buffer_conflict_stalls );
+    r.Read( _buffer_full_stalls );
+    r.Read( _buffer_reserved_stalls );
+    r.Read( _crossbar_conflict_stalls );
+  }
+}
+
 void Router::OutChannelFault( int c, bool fault )
 {
   assert( ( c >= 0 ) && ( (size_t)c < _channel_faults.size( ) ) );
@@ -141,12 +196,16 @@ bool Router::IsFaultyOutput( int c ) const
 /*Router constructor*/
 Router *Router::NewRouter( const Configuration& config,
 			   Module *parent, const string & name, int id, int inputs, int outputs,
-          vector<int> const & input_bandwidths, vector<int> const & output_bandwidths )
+          vector<int> const & input_bandwidths, vector<int> const & output_bandwidths,
+          vector<int> const & input_vc_buf_sizes, vector<int> const & output_vc_buf_sizes )
 {
   const string type = config.GetStr( "router" );
   Router *r = NULL;
   if ( type == "iq" ) {
-    r = new IQRouter( config, parent, name, id, inputs, outputs, input_bandwidths, output_bandwidths );
+    r = new IQRouter( config, parent, name, id, inputs, outputs, input_bandwidths, output_bandwidths,
+                      input_vc_buf_sizes, output_vc_buf_sizes );
+  } else if ( !input_vc_buf_sizes.empty() || !output_vc_buf_sizes.empty() ) {
+    cerr << "Per-port buffer sizes require router type iq" << endl;
   } else if ( type == "event" ) {
     r = new EventRouter( config, parent, name, id, inputs, outputs );
   } else if ( type == "chaos" ) {
@@ -74,32 +74,39 @@ protected:
   vector<CreditChannel *> _output_credits;
   vector<bool>            _channel_faults;
 
-#ifdef TRACK_FLOWS
+  // per-class counters kept only when track_flows / track_stalls is set
+  bool _track_flows;
+  bool _track_stalls;
+
   vector<vector<int> > _received_flits;
   vector<vector<int> > _stored_flits;
   vector<vector<int> > _sent_flits;
   vector<vector<int> > _outstanding_credits;
   vector<vector<int> > _active_packets;
-#endif
 
-#ifdef TRACK_STALLS
   vector<int> _buffer_busy_stalls;
   vector<int> _buffer_conflict_stalls;
   vector<int> _buffer_full_stalls;
   vector<int> _buffer_reserved_stalls;
   vector<int> _crossbar_conflict_stalls;
-#endif
 
   virtual void _InternalStep() = 0;
 
+  // state kept by all routers, for use by Save() and Load()
+  void _SaveState( CheckpointWriter & w ) const;
+  void _LoadState( CheckpointReader & r );
+
 public:
   Router( const Configuration& config,
 	  Module *parent, const string & name, int id, int inputs, int outputs,
     vector<int> const & input_bandwidths = {}, vector<int> const & output_bandwidths = {} );
 
+  // per-port vc_buf_size overrides (0 keeps the configured depth) are
+  // only supported by the input-queued router
   static Router *NewRouter( const Configuration& config,
 			    Module *parent, const string & name, int id, int inputs, int outputs,
-          vector<int> const & input_bandwidths = {}, vector<int> const & output_bandwidths = {} );
+          vector<int> const & input_bandwidths = {}, vector<int> const & output_bandwidths = {},
+          vector<int> const & input_vc_buf_sizes = {}, vector<int> const & output_vc_buf_sizes = {} );
 
   virtual void AddInputChannel( FlitChannel *channel, CreditChannel *backchannel );
   virtual void AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel );
@@ -117,6 +124,10 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( ) = 0;
 
+  // complete router state between cycles; not supported by default
+  virtual void Save( CheckpointWriter & w ) const;
+  virtual void Load( CheckpointReader & r );
+
   void OutChannelFault( int c, bool fault = true );
   bool IsFaultyOutput( int c ) const;
 
@@ -127,12 +138,9 @@ public:
   virtual int GetUsedCredit(int o) const = 0;
   virtual int GetBufferOccupancy(int i) const = 0;
 
-#ifdef TRACK_BUFFERS
   virtual int GetUsedCreditForClass(int output, int cl) const = 0;
   virtual int GetBufferOccupancyForClass(int input, int cl) const = 0;
-#endif
 
-#ifdef TRACK_FLOWS
   inline vector<int> const & GetReceivedFlits(int c) const {
     assert((c >= 0) && (c < _classes));
     return _received_flits[c];
@@ -160,13 +168,11 @@ public:
     _received_flits[c].assign(_received_flits[c].size(), 0);
     _sent_flits[c].assign(_sent_flits[c].size(), 0);
   }
-#endif
 
   virtual vector<int> UsedCredits() const = 0;
   virtual vector<int> FreeCredits() const = 0;
   virtual vector<int> MaxCredits() const = 0;
 
-#ifdef TRACK_STALLS
   inline int GetBufferBusyStalls(int c) const {
     assert((c >= 0) && (c < _classes));
     return _buffer_busy_stalls[c];
@@ -196,7 +202,6 @@ public:
     _buffer_reserved_stalls[c] = 0;
     _crossbar_conflict_stalls[c] = 0;
   }
-#endif
 
   inline int NumInputs() const {return _inputs;}
   inline int NumOutputs() const {return _outputs;}
@@ -0,0 +1,125 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*sim_context.cpp
+ *
+ *The random number generator state is per thread as well, but it is not
+ *copied on Bind(): Network seeds each worker thread from Seed() and the
+ *worker index, so its stream follows the configured seed
+ *
+ */
+
+#include <cassert>
+
+#include "sim_context.hpp"
+#include "globals.hpp"
+#include "routefunc.hpp"
+#include "random_utils.hpp"
+#include "gpunet.hpp"
+
+extern thread_local TrafficManager * trafficManager;
+
+thread_local SimContext * SimContext::_current = NULL;
+
+SimContext::SimContext()
+{
+  Capture();
+}
+
+SimContext::~SimContext()
+{
+  if(_current == this) {
+    Flit::SetPool(NULL);
+    Credit::SetPool(NULL);
+    PacketReplyInfo::SetPool(NULL);
+    _current = NULL;
+  }
+}
+
+void SimContext::Capture()
+{
+  _traffic_manager = trafficManager;
+  _print_activity = gPrintActivity;
+  _trace = gTrace;
+  _watch_out = gWatchOut;
+  _k = gK;
+  _n = gN;
+  _c = gC;
+  _nodes = gNodes;
+  _num_vcs = gNumVCs;
+  _read_req_vcs[0] = gReadReqBeginVC;
+  _read_req_vcs[1] = gReadReqEndVC;
+  _write_req_vcs[0] = gWriteReqBeginVC;
+  _write_req_vcs[1] = gWriteReqEndVC;
+  _read_reply_vcs[0] = gReadReplyBeginVC;
+  _read_reply_vcs[1] = gReadReplyEndVC;
+  _write_reply_vcs[0] = gWriteReplyBeginVC;
+  _write_reply_vcs[1] = gWriteReplyEndVC;
+  _x = gX;
+  _u = gU;
+  _gpunet_routes = gGPUNetRoutes;
+  _gpunet_partition_ports = gGPUNetPartitionPorts;
+  _gpunet_adaptive_threshold = gGPUNetAdaptiveThreshold;
+  _seed = gRandomSeed;
+}
+
+void SimContext::Bind()
+{
+  Flit::SetPool(&_flits);
+  Credit::SetPool(&_credits);
+  PacketReplyInfo::SetPool(&_replies);
+  _current = this;
+
+  trafficManager = _traffic_manager;
+  gPrintActivity = _print_activity;
+  gTrace = _trace;
+  gWatchOut = _watch_out;
+  gK = _k;
+  gN = _n;
+  gC = _c;
+  gNodes = _nodes;
+  gNumVCs = _num_vcs;
+  gReadReqBeginVC = _read_req_vcs[0];
+  gReadReqEndVC = _read_req_vcs[1];
+  gWriteReqBeginVC = _write_req_vcs[0];
+  gWriteReqEndVC = _write_req_vcs[1];
+  gReadReplyBeginVC = _read_reply_vcs[0];
+  gReadReplyEndVC = _read_reply_vcs[1];
+  gWriteReplyBeginVC = _write_reply_vcs[0];
+  gWriteReplyEndVC = _write_reply_vcs[1];
+  gX = _x;
+  gU = _u;
+  gGPUNetRoutes = _gpunet_routes;
+  gGPUNetPartitionPorts = _gpunet_partition_ports;
+  gGPUNetAdaptiveThreshold = _gpunet_adaptive_threshold;
+}
+
+SimContext * SimContext::Current()
+{
+  return _current;
+}
@@ -0,0 +1,98 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*sim_context.hpp
+ *
+ *Everything a single simulation keeps outside of its network and traffic
+ *manager objects: the flit, credit and reply pools plus the per-thread
+ *globals (gK, gNumVCs, trafficManager, ...). Binding a context to a thread
+ *points that thread's globals at it, so independent simulations can run on
+ *different threads of one process and worker threads can join a running one
+ *
+ */
+
+#ifndef _SIM_CONTEXT_HPP_
+#define _SIM_CONTEXT_HPP_
+
+#include <iostream>
+#include <vector>
+
+#include "flit.hpp"
+#include "credit.hpp"
+#include "packet_reply_info.hpp"
+
+class TrafficManager;
+
+class SimContext {
+
+  Flit::Pool _flits;
+  Credit::Pool _credits;
+  PacketReplyInfo::Pool _replies;
+
+  // snapshot of the owning thread's globals, see Capture()
+  TrafficManager * _traffic_manager;
+  bool _print_activity;
+  bool _trace;
+  ostream * _watch_out;
+  int _k;
+  int _n;
+  int _c;
+  int _nodes;
+  int _num_vcs;
+  int _read_req_vcs[2];
+  int _write_req_vcs[2];
+  int _read_reply_vcs[2];
+  int _write_reply_vcs[2];
+  int _x;
+  vector<int> _u;
+  int const * _gpunet_routes;
+  int const * _gpunet_partition_ports;
+  int _gpunet_adaptive_threshold;
+  long _seed;
+
+  static thread_local SimContext * _current;
+
+public:
+
+  // starts out with a copy of the calling thread's globals
+  SimContext();
+  ~SimContext();
+
+  // record the calling thread's globals
+  void Capture();
+  // make this context (pools and recorded globals) current on this thread
+  void Bind();
+
+  // seed of the capturing thread's random number generator
+  inline long Seed() const { return _seed; }
+
+  static SimContext * Current();
+
+};
+
+#endif
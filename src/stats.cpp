@@ -39,6 +39,7 @@
 #include <limits>
 #include <cmath>
 #include <cstdio>
+#include <algorithm>
 
 #include "stats.hpp"
 
@@ -56,6 +57,7 @@ void Stats::Clear( )
   _sample_squared_sum = 0.0;
 
   _hist.assign(_num_bins, 0);
+  _log_hist.clear();
 
   _min = numeric_limits<double>::quiet_NaN();
   _max = -numeric_limits<double>::quiet_NaN();
@@ -112,6 +114,58 @@ void Stats::AddSample( double val )
   b = (b >= _num_bins) ? (_num_bins - 1) : b;
 
   _hist[b]++;
+
+  int const lb = _LogBin(val);
+  if(lb >= (int)_log_hist.size()) {
+    _log_hist.resize(lb + 1, 0);
+  }
+  _log_hist[lb]++;
+}
+
+int Stats::_LogBin( double val )
+{
+  int const sub = 1 << _sub_bits;
+  // negative and NaN samples count as zero
+  if(!(val >= 0.0)) {
+    return 0;
+  }
+  if(val < sub) {
+    return (int)val;
+  }
+  // 2^k <= val < 2^(k+1), split into sub buckets
+  int e;
+  frexp(fmin(val, 0x1p62), &e);
+  int const k = e - 1;
+  int const s = (int)ldexp(fmin(val, 0x1p62), _sub_bits - k);
+  return ((k - _sub_bits) << _sub_bits) + s;
+}
+
+double Stats::Percentile( double p ) const
+{
+  if(_num_samples == 0) {
+    return numeric_limits<double>::quiet_NaN();
+  }
+  int const sub = 1 << _sub_bits;
+  double const rank = fmax(ceil(p * (double)_num_samples), 1.0);
+  if(rank >= _num_samples) {
+    return _max;
+  }
+  int seen = 0;
+  int b = 0;
+  for(; b < (int)_log_hist.size() - 1; ++b) {
+    seen += _log_hist[b];
+    if(seen >= rank) {
+      break;
+    }
+  }
+  // middle of the bucket, rounded down to an integer for integer samples
+  double val = b;
+  if(b >= sub) {
+    int const shift = (b >> _sub_bits) - 1;
+    double const width = ldexp(1.0, shift);
+    val = ldexp((double)((b & (sub - 1)) + sub), shift) + floor((width - 1.0) / 2.0);
+  }
+  return min(max(val, _min), _max);
 }
 
 void Stats::Display( ostream & os ) const
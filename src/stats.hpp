@@ -44,6 +44,15 @@ class Stats : public Module {
 
   vector<int> _hist;
 
+  // log-bucketed histogram for percentiles: values below 2^_sub_bits get
+  // buckets of width one, and every further power of two is split into
+  // 2^_sub_bits buckets, so percentiles are within 2^-_sub_bits of the
+  // samples; it only grows with the largest sample
+  static const int _sub_bits = 5;
+  vector<int> _log_hist;
+
+  static int _LogBin( double val );
+
 public:
   Stats( Module *parent, const string &name,
 	 double bin_size = 1.0, int num_bins = 10 );
@@ -58,6 +67,10 @@ public:
   double SquaredSum( ) const;
   int    NumSamples( ) const;
 
+  // smallest sample that at least a fraction p of all samples do not
+  // exceed, for p in [0,1]
+  double Percentile( double p ) const;
+
   void AddSample( double val );
   inline void AddSample( int val ) {
     AddSample( (double)val );
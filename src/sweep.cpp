@@ -0,0 +1,278 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*sweep.cpp
+ *
+ *Every point is an independent Simulate() call on a copy of the parsed
+ *configuration, so it gets its own SimContext. Rates are handed out in
+ *increasing order; once a rate turns out unstable, no higher rate is
+ *started. The console output of each point is buffered and printed in rate
+ *order after the sweep, so it reads like a series of separate runs.
+ *Output files named in the configuration get the index of the point
+ *inserted before their extension (stats.m becomes stats.2.m), so points
+ *running at the same time do not write the same file
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+
+#include "booksim.hpp"
+#include "sweep.hpp"
+#include "globals.hpp"
+#include "misc_utils.hpp"
+#include "worker_pool.hpp"
+
+/* sends everything written to it to the stream buffer registered by the
+ * writing thread, or to the original buffer for all other threads
+ */
+class ThreadRoutedBuf : public streambuf {
+  streambuf * _fallback;
+
+  static thread_local streambuf * _target;
+
+  inline streambuf * _Target() const {
+    return _target ? _target : _fallback;
+  }
+
+protected:
+  virtual int overflow( int c ) {
+    return ( c == EOF ) ? 0 : _Target()->sputc( c );
+  }
+  virtual streamsize xsputn( char const * s, streamsize n ) {
+    return _Target()->sputn( s, n );
+  }
+  virtual int sync() {
+    return _Target()->pubsync();
+  }
+
+public:
+  ThreadRoutedBuf( streambuf * fallback ) : _fallback( fallback ) {}
+
+  static void SetTarget( streambuf * target ) {
+    _target = target;
+  }
+};
+
+thread_local streambuf * ThreadRoutedBuf::_target = NULL;
+
+enum PointStatus { pending, stable, unstable, skipped };
+
+// options naming files written by a simulation; "-" stands for the console
+static char const * const gPointFiles[] = {
+  "stats_out", "watch_out", "util_out", "checkpoint_out",
+  "injected_flits_out", "received_flits_out", "stored_flits_out",
+  "sent_flits_out", "outstanding_credits_out", "ejected_flits_out",
+  "active_packets_out", "used_credits_out", "free_credits_out",
+  "max_credits_out", "sent_packets_out", "power_output_file"
+};
+
+static string _PointFile( string const & name, int point )
+{
+  if ( ( name == "" ) || ( name == "-" ) ) {
+    return name;
+  }
+  size_t const dir = name.find_last_of( '/' );
+  size_t const ext = name.find_last_of( '.' );
+  ostringstream file;
+  if ( ( ext != string::npos ) && ( ext > 0 ) &&
+       ( ( dir == string::npos ) || ( ext > dir + 1 ) ) ) {
+    file << name.substr( 0, ext ) << '.' << point << name.substr( ext );
+  } else {
+    file << name << '.' << point;
+  }
+  return file.str();
+}
+
+struct SweepPoint {
+  double rate;
+  PointStatus status;
+  ostringstream log;
+  ostringstream csv;
+};
+
+struct SweepState {
+  BookSimConfig const * config;
+  vector<SweepPoint> points;
+  atomic<int> next;
+  // lowest rate that was unstable so far
+  double saturation;
+  mutex lock;
+  ostream * console;
+};
+
+static void _SweepWorker( void * arg, int worker )
+{
+  SweepState * const state = static_cast<SweepState *>( arg );
+  int const count = state->points.size();
+  for ( int p = state->next++; p < count; p = state->next++ ) {
+    SweepPoint & point = state->points[p];
+    {
+      lock_guard<mutex> guard( state->lock );
+      if ( point.rate > state->saturation ) {
+        point.status = skipped;
+        continue;
+      }
+      // the point's own output only shows up after the sweep
+      *state->console << "SWEEP: Simulating injection rate " << point.rate
+                      << "..." << endl;
+    }
+
+    BookSimConfig config( *state->config );
+    config.Assign( "injection_rate", point.rate );
+    config.Assign( "injection_rate", string( "" ) );
+    for ( size_t i = 0; i < sizeof( gPointFiles ) / sizeof( gPointFiles[0] ); ++i ) {
+      config.Assign( gPointFiles[i], _PointFile( config.GetStr( gPointFiles[i] ), p ) );
+    }
+
+    ThreadRoutedBuf::SetTarget( point.log.rdbuf() );
+    bool const result = Simulate( config, &point.csv );
+    ThreadRoutedBuf::SetTarget( NULL );
+
+    lock_guard<mutex> guard( state->lock );
+    point.status = result ? stable : unstable;
+    if ( !result ) {
+      state->saturation = min( state->saturation, point.rate );
+    }
+    *state->console << "SWEEP: Injection rate " << point.rate
+                    << ( result ? " completed" : " unstable" ) << endl;
+  }
+}
+
+static vector<double> _SweepRates( BookSimConfig const & config )
+{
+  vector<double> rates = config.GetFloatArray( "sweep_rates" );
+  if ( rates.empty() ) {
+    double const lo = config.GetFloat( "sweep_rate_min" );
+    double const hi = config.GetFloat( "sweep_rate_max" );
+    double const step = config.GetFloat( "sweep_rate_step" );
+    if ( hi < lo ) {
+      cout << "Error: sweep_rate_max must not be smaller than sweep_rate_min" << endl;
+      exit(-1);
+    }
+    // tolerate rounding in the last step of the range
+    for ( int i = 0; lo + i * step <= hi + 1e-9 * step; ++i ) {
+      rates.push_back( lo + i * step );
+    }
+  }
+  sort( rates.begin(), rates.end() );
+  rates.erase( unique( rates.begin(), rates.end() ), rates.end() );
+  if ( rates.empty() || ( rates.front() <= 0.0 ) ) {
+    cout << "Error: Sweep injection rates must be positive." << endl;
+    exit(-1);
+  }
+  return rates;
+}
+
+bool IsSweep( BookSimConfig const & config )
+{
+  return ( config.GetStr( "sweep_rates" ) != "" ) ||
+    ( config.GetFloat( "sweep_rate_step" ) > 0.0 );
+}
+
+bool Sweep( BookSimConfig const & config )
+{
+  vector<double> const rates = _SweepRates( config );
+
+  SweepState state;
+  state.config = &config;
+  state.points = vector<SweepPoint>( rates.size() );
+  for ( size_t p = 0; p < rates.size(); ++p ) {
+    state.points[p].rate = rates[p];
+    state.points[p].status = pending;
+  }
+  state.next = 0;
+  state.saturation = rates.back() + 1.0;
+
+  int threads = config.GetInt( "sweep_threads" );
+  if ( threads <= 0 ) {
+    threads = max( (int)thread::hardware_concurrency(), 1 );
+  }
+  threads = min( threads, (int)rates.size() );
+
+  cout << "SWEEP: Running " << rates.size() << " injection rates on "
+       << threads << " threads" << endl;
+
+  streambuf * const console_buf = cout.rdbuf();
+  ostream console( console_buf );
+  state.console = &console;
+  ThreadRoutedBuf routed( console_buf );
+  cout.rdbuf( &routed );
+  {
+    WorkerPool pool( threads );
+    pool.Run( &_SweepWorker, &state );
+  }
+  cout.rdbuf( console_buf );
+
+  string const out_file = config.GetStr( "sweep_out" );
+  ofstream csv( out_file.c_str() );
+  if ( !csv ) {
+    cout << "Error: Could not open sweep output file " << out_file << endl;
+    exit(-1);
+  }
+  bool header = false;
+  double saturation = 0.0;
+  for ( size_t p = 0; p < state.points.size(); ++p ) {
+    SweepPoint const & point = state.points[p];
+    string const status =
+      ( point.status == stable ) ? "stable" :
+      ( point.status == unstable ) ? "unstable" : "skipped";
+    if ( point.status != skipped ) {
+      cout << "SWEEP: Output for injection rate " << point.rate << endl
+           << point.log.str();
+    }
+    if ( point.status != stable ) {
+      csv << point.rate << ',' << status << endl;
+      continue;
+    }
+    saturation = point.rate;
+    // the first line of each point holds the column names
+    istringstream rows( point.csv.str() );
+    string row;
+    getline( rows, row );
+    if ( !header ) {
+      csv << "injection_rate,status," << row << endl;
+      header = true;
+    }
+    while ( getline( rows, row ) ) {
+      csv << point.rate << ',' << status << ',' << row << endl;
+    }
+  }
+
+  cout << "SWEEP: Parameter sweep complete." << endl;
+  cout << "SWEEP: Saturation throughput: " << saturation << endl;
+  cout << "SWEEP: Results written to " << out_file << endl;
+
+  return state.points.front().status == stable;
+}
@@ -25,11 +25,14 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <ctime>
 #include "random_utils.hpp"
 #include "traffic.hpp"
+#include "address_hash.hpp"
+#include "checkpoint.hpp"
 
 TrafficPattern::TrafficPattern(int nodes)
 : _nodes(nodes)
@@ -193,6 +196,8 @@ TrafficPattern * TrafficPattern::New(string const & pattern, int nodes,
     result = new HotSpotTrafficPattern(nodes, hotspots, rates);
   } else if(pattern_name == "gpu") {
     result = new GPUTrafficPattern(nodes, config);
+  } else if(pattern_name == "gpu_interleave") {
+    result = new GPUInterleaveTrafficPattern(nodes, config);
   }
     else {
     cout << "Error: Unknown traffic pattern: " << pattern << endl;
@@ -534,6 +539,34 @@ GPUTrafficPattern::GPUTrafficPattern(int nodes, Configuration const * const conf
 {
   _nodes_sm = config->GetInt("sm");
   _nodes_l2slice = config->GetInt("l2slice");
+
+  // partition geometry as built by GPUNet
+  _l = config->GetInt("l");
+  _partition = (config->GetInt("partition") == 1);
+  _dies = max(config->GetInt("dies"), 1);
+  _ratio = config->GetIntArray("units");
+  if (_ratio.size() < size_t(_l)) {
+    _ratio.resize(_l, 1);
+  }
+  int const sm_die = _nodes_sm / _dies;
+  _total_units.resize(_l);
+  _offsets.resize(_l, 0);
+  for (int l = 0; l < _l; ++l) {
+    int const below = (l == 0) ? sm_die : _total_units[l - 1];
+    _total_units[l] = (_ratio[l] > 0) ? below / _ratio[l] : 0;
+    if (l > 0) {
+      _offsets[l] = _total_units[l - 1] + _offsets[l - 1];
+    }
+  }
+  _p = (_partition && (_l > 0)) ? _total_units[_l - 1] : 1;
+  _l2slice_p = (_p > 0) ? _nodes_l2slice / _dies / _p : 0;
+  int const sm_p = (_p > 0) ? sm_die / _p : 0;
+  if ((sm_p > 0) && (_l2slice_p > 0)) {
+    _part_for_sm.resize(_nodes_sm);
+    for (int sm = 0; sm < _nodes_sm; ++sm) {
+      _part_for_sm[sm] = (sm % sm_die) / sm_p;
+    }
+  }
 }
 
 int GPUTrafficPattern::dest(int source)
@@ -544,4 +577,88 @@ int GPUTrafficPattern::dest(int source)
     }
     
     return _nodes_sm + RandomInt(_nodes - _nodes_sm - 1);
-}
\ No newline at end of file
+}
+
+GPUInterleaveTrafficPattern::GPUInterleaveTrafficPattern(int nodes, Configuration const * const config)
+  : GPUTrafficPattern(nodes, config)
+{
+  if (_part_for_sm.empty()) {
+    cout << "Error: gpu_interleave traffic needs SMs and L2 slices that "
+         << "divide evenly into the GPUNet partitions." << endl;
+    exit(-1);
+  }
+  _hash = new AddressHash(*config, _nodes_l2slice);
+  _block = config->GetInt("l2_interleave");
+  _local_fraction = config->GetFloat("gpu_local_fraction");
+  if (_local_fraction > 1.0) {
+    cout << "Error: gpu_local_fraction must be at most 1.0." << endl;
+    exit(-1);
+  }
+  // remote requests are hashed over the slices outside the partition only
+  _remote_hash = NULL;
+  if ((_local_fraction >= 0.0) && (_nodes_l2slice > _l2slice_p)) {
+    _remote_hash = new AddressHash(*config, _nodes_l2slice - _l2slice_p);
+  }
+  _stride = config->GetInt("gpu_stride");
+  reset();
+}
+
+GPUInterleaveTrafficPattern::~GPUInterleaveTrafficPattern()
+{
+  delete _hash;
+  if (_remote_hash) {
+    delete _remote_hash;
+  }
+}
+
+void GPUInterleaveTrafficPattern::reset()
+{
+  // strided streams start at consecutive blocks
+  _next_block.resize(_nodes_sm);
+  for (int sm = 0; sm < _nodes_sm; ++sm) {
+    _next_block[sm] = sm;
+  }
+}
+
+int GPUInterleaveTrafficPattern::dest(int source)
+{
+  if (source >= _nodes_sm) {
+    return -1;
+  }
+
+  unsigned long long block;
+  if (_stride > 0) {
+    block = _next_block[source];
+    _next_block[source] += _stride;
+  } else {
+    block = RandomIntLong();
+  }
+  int slice = _hash->Slice(block * _block);
+  if (_local_fraction < 0.0) {
+    return _nodes_sm + slice;
+  }
+
+  // exactly _local_fraction of the requests stay within the partition
+  int const die = source / (_nodes_sm / _dies);
+  int const local = die * (_nodes_l2slice / _dies)
+    + _part_for_sm[source] * _l2slice_p;
+  if (!_remote_hash || (RandomFloat() < _local_fraction)) {
+    slice = local + slice % _l2slice_p;
+  } else {
+    slice = _remote_hash->Slice(block * _block);
+    if (slice >= local) {
+      slice += _l2slice_p;
+    }
+  }
+  return _nodes_sm + slice;
+}
+
+void GPUInterleaveTrafficPattern::Save(CheckpointWriter & writer) const
+{
+  writer.Write(_next_block);
+}
+
+void GPUInterleaveTrafficPattern::Load(CheckpointReader & reader)
+{
+  reader.Read(_next_block);
+}
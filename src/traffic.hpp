@@ -32,6 +32,10 @@
 #include <set>
 #include "config_utils.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+class AddressHash;
+
 using namespace std;
 
 class TrafficPattern {
@@ -42,6 +46,8 @@ public:
   virtual ~TrafficPattern() {}
   virtual void reset();
   virtual int dest(int source) = 0;
+  virtual void Save(CheckpointWriter & writer) const {}
+  virtual void Load(CheckpointReader & reader) {}
   static TrafficPattern * New(string const & pattern, int nodes, 
 			      Configuration const * const config = NULL);
 };
@@ -172,16 +178,19 @@ public:
 };
 
 class GPUTrafficPattern : public TrafficPattern {
-private:
+protected:
   vector<int> _ratio;
   vector<int> _total_units;
   vector<int> _offsets;
   int _l;
   bool _partition;
+  int _dies;
+  int _p;
   int _nodes_sm;
   int _nodes_l2slice;
   int _l2slice_p;
-  vector<int> _part_for_sm; // Partition for each SM
+  vector<int> _part_for_sm; // Partition for each SM, empty if the
+                            // SMs do not split evenly into partitions
 public:
   GPUTrafficPattern(int nodes, Configuration const * const config);
   virtual int dest(int source);
@@ -190,4 +199,23 @@ public:
   inline int GetL2SliceP() const { return _l2slice_p; }
   inline int GetPartitionForSM(int sm) const { return _part_for_sm[sm]; }
 };
+
+// SM requests to the L2 slice that a hash of a synthetic address picks,
+// optionally with a set fraction of them in the SM's own die and partition
+class GPUInterleaveTrafficPattern : public GPUTrafficPattern {
+private:
+  AddressHash * _hash;
+  AddressHash * _remote_hash;
+  unsigned long long _block;
+  double _local_fraction;
+  int _stride;
+  vector<unsigned long long> _next_block;
+public:
+  GPUInterleaveTrafficPattern(int nodes, Configuration const * const config);
+  virtual ~GPUInterleaveTrafficPattern();
+  virtual void reset();
+  virtual int dest(int source);
+  virtual void Save(CheckpointWriter & writer) const;
+  virtual void Load(CheckpointReader & reader);
+};
 #endif
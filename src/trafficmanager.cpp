@@ -36,9 +36,52 @@
 #include "booksim_config.hpp"
 #include "trafficmanager.hpp"
 #include "batchtrafficmanager.hpp"
+#include "kerneltrafficmanager.hpp"
 #include "random_utils.hpp" 
 #include "vc.hpp"
 #include "packet_reply_info.hpp"
+#include "checkpoint.hpp"
+#include "iq_router.hpp"
+
+// latency percentiles reported along with minimum, average and maximum
+static int const gNumTailPercentiles = 4;
+static double const gTailPercentiles[gNumTailPercentiles] = { 0.5, 0.9, 0.99, 0.999 };
+static char const * const gTailNames[gNumTailPercentiles] = { "p50", "p90", "p99", "p99.9" };
+
+// phases of _Step timed with profile = 1
+enum eProfilePhase { prof_eject = 0, prof_read_inputs, prof_inject, prof_retire,
+                     prof_evaluate, prof_write_outputs, prof_phases };
+static char const * const gProfilePhases[prof_phases] = {
+    "eject", "read_inputs", "inject", "retire", "evaluate", "write_outputs" };
+
+static void _DisplayTail( ostream & os, Stats const * s )
+{
+    os << "	";
+    for ( int i = 0; i < gNumTailPercentiles; ++i ) {
+        os << ( i ? ", " : "" ) << gTailNames[i] << " = "
+           << s->Percentile( gTailPercentiles[i] );
+    }
+    os << endl;
+}
+
+// percentiles as a matlab row, c+1 as for the other per-class arrays
+static void _WriteTail( ostream & os, char const * name, int c, Stats const * s )
+{
+    os << name << "(" << c+1 << ",:) = [ ";
+    for ( int i = 0; i < gNumTailPercentiles; ++i ) {
+        os << s->Percentile( gTailPercentiles[i] ) << " ";
+    }
+    os << "];" << endl;
+}
+
+static void _DisplayOverallTail( ostream & os, vector<double> const & sums, int sims )
+{
+    os << "	";
+    for ( int i = 0; i < gNumTailPercentiles; ++i ) {
+        os << ( i ? ", " : "" ) << gTailNames[i] << " = " << sums[i] / (double)sims;
+    }
+    os << " (" << sims << " samples)" << endl;
+}
 
 TrafficManager * TrafficManager::New(Configuration const & config,
                                      vector<Network *> const & net)
@@ -49,6 +92,8 @@ TrafficManager * TrafficManager::New(Configuration const & config,
         result = new TrafficManager(config, net);
     } else if(sim_type == "batch") {
         result = new BatchTrafficManager(config, net);
+    } else if(sim_type == "kernel") {
+        result = new KernelTrafficManager(config, net);
     } else {
         cerr << "Unknown simulation type: " << sim_type << endl;
     } 
@@ -64,6 +109,11 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 
     _vcs = config.GetInt("num_vcs");
     _subnets = config.GetInt("subnets");
+
+    _track_flows = (config.GetInt("track_flows") > 0);
+    _track_stalls = (config.GetInt("track_stalls") > 0);
+    _track_buffers = (config.GetInt("track_buffers") > 0);
+    _track_credits = (config.GetInt("track_credits") > 0);
  
     _subnet.resize(Flit::NUM_FLIT_TYPES);
     _subnet[Flit::READ_REQUEST] = config.GetInt("read_request_subnet");
@@ -152,6 +202,23 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     }
     _write_reply_size.resize(_classes, _write_reply_size.back());
 
+    _flit_width = config.GetInt("flit_width");
+    _header_bytes = config.GetInt("header_bytes");
+    if(_flit_width > 0) {
+        int const line_bytes = config.GetInt("line_bytes");
+        int write_bytes = config.GetInt("write_bytes");
+        if(write_bytes <= 0) {
+            write_bytes = line_bytes;
+        }
+        if((_header_bytes < 0) || (line_bytes < 0)) {
+            Error("header_bytes and line_bytes must not be negative");
+        }
+        _read_request_size.assign(_classes, _BytesToFlits(_header_bytes));
+        _read_reply_size.assign(_classes, _BytesToFlits(_header_bytes + line_bytes));
+        _write_request_size.assign(_classes, _BytesToFlits(_header_bytes + write_bytes));
+        _write_reply_size.assign(_classes, _BytesToFlits(_header_bytes));
+    }
+
     string packet_size_str = config.GetStr("packet_size");
     if(packet_size_str.empty()) {
         _packet_size.push_back(vector<int>(1, config.GetInt("packet_size")));
@@ -232,6 +299,64 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _injection_process[c] = InjectionProcess::New(injection_process[c], _nodes, _load[c], &config);
     }
 
+    _trace = NULL;
+    _trace_hash = NULL;
+    string const trace_file = config.GetStr("trace_file");
+    if(trace_file != "") {
+        _trace_class = config.GetInt("trace_class");
+        if((_trace_class < 0) || (_trace_class >= _classes)) {
+            Error("trace_class is not a valid class");
+        }
+        _nodes_sm = config.GetInt("sm");
+        int const l2slices = config.GetInt("l2slice");
+        if((_nodes_sm <= 0) || (_nodes_sm + l2slices > _nodes)) {
+            Error("Trace replay needs sm SMs followed by l2slice L2 slices");
+        }
+        _trace = new MemoryTrace(trace_file, _nodes_sm,
+                                 config.GetInt("trace_lookahead"),
+                                 config.GetInt("trace_buffer"));
+        _trace_hash = new AddressHash(config, l2slices);
+    }
+
+    _mcast_class = config.GetInt("mcast_class");
+    if(_mcast_class >= 0) {
+        if(_mcast_class >= _classes) {
+            Error("mcast_class is not a valid class");
+        }
+        if(_use_read_write[_mcast_class]) {
+            Error("mcast_class cannot use read/write requests");
+        }
+        if(config.GetStr("router") != "iq") {
+            Error("Multicast packets are only replicated by iq routers");
+        }
+        if(!config.GetStr("checkpoint_out").empty() ||
+           !config.GetStr("checkpoint_in").empty()) {
+            Error("Checkpoints are not supported with multicast");
+        }
+        _nodes_sm = config.GetInt("sm");
+        _nodes_l2slice = config.GetInt("l2slice");
+        if((_nodes_sm <= 0) || (_nodes_sm + _nodes_l2slice > _nodes)) {
+            Error("Multicast needs sm SMs followed by l2slice L2 slices");
+        }
+        _mcast_group = config.GetInt("mcast_group");
+        if(_mcast_group <= 0) {
+            _mcast_group = _nodes_sm;
+        }
+        if(_nodes_sm % _mcast_group) {
+            Error("mcast_group must divide the number of SMs");
+        }
+        _mcast_unicast = (config.GetInt("mcast_unicast") > 0);
+        // copies of a packet hold its buffer slots until all have left,
+        // so the whole packet has to fit into the buffer of a VC
+        int const buf_size = config.GetInt("buf_size");
+        int const vc_buf_size = (buf_size > 0) ?
+            (buf_size / config.GetInt("num_vcs")) : config.GetInt("vc_buf_size");
+        if(*max_element(_packet_size[_mcast_class].begin(),
+                        _packet_size[_mcast_class].end()) > vc_buf_size) {
+            Error("Multicast packets must fit into the buffer of a VC");
+        }
+    }
+
     // ============ Injection VC states  ============ 
 
     _buf_states.resize(_nodes);
@@ -256,16 +381,16 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         }
     }
 
-#ifdef TRACK_FLOWS
-    _outstanding_credits.resize(_classes);
-    for(int c = 0; c < _classes; ++c) {
-        _outstanding_credits[c].resize(_subnets, vector<int>(_nodes, 0));
-    }
-    _outstanding_classes.resize(_nodes);
-    for(int n = 0; n < _nodes; ++n) {
-        _outstanding_classes[n].resize(_subnets, vector<queue<int> >(_vcs));
+    if(_track_flows) {
+        _outstanding_credits.resize(_classes);
+        for(int c = 0; c < _classes; ++c) {
+            _outstanding_credits[c].resize(_subnets, vector<int>(_nodes, 0));
+        }
+        _outstanding_classes.resize(_nodes);
+        for(int n = 0; n < _nodes; ++n) {
+            _outstanding_classes[n].resize(_subnets, vector<queue<int> >(_vcs));
+        }
     }
-#endif
 
     // ============ Injection queues ============ 
 
@@ -287,6 +412,18 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _repliesPending.resize(_nodes);
     _requestsOutstanding.resize(_nodes);
 
+    _mshrs = config.GetInt("mshrs");
+    _l2_latency = config.GetInt("l2_latency");
+    _l2_bandwidth = config.GetInt("l2_bandwidth");
+    _l2_queue_size = config.GetInt("l2_queue_size");
+    if((_mshrs < 0) || (_l2_latency < 0) || (_l2_bandwidth < 0) || (_l2_queue_size < 0)) {
+        Error("mshrs, l2_latency, l2_bandwidth and l2_queue_size must not be negative");
+    }
+    _l2_slot_time.resize(_nodes, 0);
+    _l2_slot_used.resize(_nodes, 0);
+    _held_credits.resize(_nodes, vector<deque<int> >(_subnets));
+    _held_flits = 0;
+
     _hold_switch_for_packet = config.GetInt("hold_switch_for_packet");
 
     // ============ Simulation parameters ============ 
@@ -298,6 +435,21 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _router[i] = _net[i]->GetRouters();
     }
 
+    _util_sampler = NULL;
+    string const util_out = config.GetStr( "util_out" );
+    if ( util_out != "" ) {
+        int const util_period = config.GetInt( "util_sample_period" );
+        if ( util_period <= 0 ) {
+            Error( "util_sample_period must be positive" );
+        }
+        _util_sampler = new UtilizationSampler( _net, util_out, util_period );
+    }
+
+    _profiler = NULL;
+    if ( config.GetInt( "profile" ) > 0 ) {
+        _profiler = new Profiler( vector<string>( gProfilePhases, gProfilePhases + prof_phases ) );
+    }
+
     //seed the network
     int seed;
     if(config.GetStr("seed") == "time") {
@@ -354,8 +506,20 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _include_queuing = config.GetInt( "include_queuing" );
 
     _print_csv_results = config.GetInt( "print_csv_results" );
+
+    _checkpoint_out = config.GetStr( "checkpoint_out" );
+    _checkpoint_in = config.GetStr( "checkpoint_in" );
     _deadlock_warn_timeout = config.GetInt( "deadlock_warn_timeout" );
 
+    // idle input-queued routers keep no per-cycle state beyond the activity
+    // monitors and the fractional part of the internal speedup, so only
+    // those can be skipped without changing the results, and only with an
+    // integral speedup
+    double const internal_speedup = config.GetFloat( "internal_speedup" );
+    _fast_forward = ( config.GetInt( "fast_forward" ) > 0 ) && 
+        ( config.GetStr( "router" ) == "iq" ) && !gPrintActivity &&
+        ( internal_speedup == floor( internal_speedup ) );
+
     string watch_file = config.GetStr( "watch_file" );
     if((watch_file != "") && (watch_file != "-")) {
         _LoadWatchList(watch_file);
@@ -381,7 +545,6 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         config.WriteMatlabFile(_stats_out);
     }
   
-#ifdef TRACK_FLOWS
     _injected_flits.resize(_classes, vector<int>(_nodes, 0));
     _ejected_flits.resize(_classes, vector<int>(_nodes, 0));
     string injected_flits_out_file = config.GetStr( "injected_flits_out" );
@@ -426,9 +589,7 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     } else {
         _active_packets_out = new ofstream(active_packets_out_file.c_str());
     }
-#endif
 
-#ifdef TRACK_CREDITS
     string used_credits_out_file = config.GetStr( "used_credits_out" );
     if(used_credits_out_file == "") {
         _used_credits_out = NULL;
@@ -447,7 +608,6 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     } else {
         _max_credits_out = new ofstream(max_credits_out_file.c_str());
     }
-#endif
 
     // ============ Statistics ============ 
 
@@ -466,15 +626,17 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_avg_flat.resize(_classes, 0.0);
     _overall_max_flat.resize(_classes, 0.0);
 
+    _overall_tail_plat.resize(_classes, vector<double>(gNumTailPercentiles, 0.0));
+    _overall_tail_nlat.resize(_classes, vector<double>(gNumTailPercentiles, 0.0));
+    _overall_tail_flat.resize(_classes, vector<double>(gNumTailPercentiles, 0.0));
+
     _frag_stats.resize(_classes);
     _overall_min_frag.resize(_classes, 0.0);
     _overall_avg_frag.resize(_classes, 0.0);
     _overall_max_frag.resize(_classes, 0.0);
 
     if(_pair_stats){
-        _pair_plat.resize(_classes);
-        _pair_nlat.resize(_classes);
-        _pair_flat.resize(_classes);
+        _pair_lat.resize(_classes);
     }
   
     _hop_stats.resize(_classes);
@@ -498,18 +660,18 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _overall_avg_accepted.resize(_classes, 0.0);
     _overall_max_accepted.resize(_classes, 0.0);
 
-#ifdef TRACK_STALLS
-    _buffer_busy_stalls.resize(_classes);
-    _buffer_conflict_stalls.resize(_classes);
-    _buffer_full_stalls.resize(_classes);
-    _buffer_reserved_stalls.resize(_classes);
-    _crossbar_conflict_stalls.resize(_classes);
-    _overall_buffer_busy_stalls.resize(_classes, 0);
-    _overall_buffer_conflict_stalls.resize(_classes, 0);
-    _overall_buffer_full_stalls.resize(_classes, 0);
-    _overall_buffer_reserved_stalls.resize(_classes, 0);
-    _overall_crossbar_conflict_stalls.resize(_classes, 0);
-#endif
+    if(_track_stalls) {
+        _buffer_busy_stalls.resize(_classes);
+        _buffer_conflict_stalls.resize(_classes);
+        _buffer_full_stalls.resize(_classes);
+        _buffer_reserved_stalls.resize(_classes);
+        _crossbar_conflict_stalls.resize(_classes);
+        _overall_buffer_busy_stalls.resize(_classes, 0);
+        _overall_buffer_conflict_stalls.resize(_classes, 0);
+        _overall_buffer_full_stalls.resize(_classes, 0);
+        _overall_buffer_reserved_stalls.resize(_classes, 0);
+        _overall_crossbar_conflict_stalls.resize(_classes, 0);
+    }
 
     for ( int c = 0; c < _classes; ++c ) {
         ostringstream tmp_name;
@@ -539,43 +701,17 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _stats[tmp_name.str()] = _hop_stats[c];
         tmp_name.str("");
 
-        if(_pair_stats){
-            _pair_plat[c].resize(_nodes*_nodes);
-            _pair_nlat[c].resize(_nodes*_nodes);
-            _pair_flat[c].resize(_nodes*_nodes);
-        }
-
         _sent_packets[c].resize(_nodes, 0);
         _accepted_packets[c].resize(_nodes, 0);
         _sent_flits[c].resize(_nodes, 0);
         _accepted_flits[c].resize(_nodes, 0);
 
-#ifdef TRACK_STALLS
-        _buffer_busy_stalls[c].resize(_subnets*_routers, 0);
-        _buffer_conflict_stalls[c].resize(_subnets*_routers, 0);
-        _buffer_full_stalls[c].resize(_subnets*_routers, 0);
-        _buffer_reserved_stalls[c].resize(_subnets*_routers, 0);
-        _crossbar_conflict_stalls[c].resize(_subnets*_routers, 0);
-#endif
-        if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    tmp_name << "pair_plat_stat_" << c << "_" << i << "_" << j;
-                    _pair_plat[c][i*_nodes+j] = new Stats( this, tmp_name.str( ), 1.0, 250 );
-                    _stats[tmp_name.str()] = _pair_plat[c][i*_nodes+j];
-                    tmp_name.str("");
-	  
-                    tmp_name << "pair_nlat_stat_" << c << "_" << i << "_" << j;
-                    _pair_nlat[c][i*_nodes+j] = new Stats( this, tmp_name.str( ), 1.0, 250 );
-                    _stats[tmp_name.str()] = _pair_nlat[c][i*_nodes+j];
-                    tmp_name.str("");
-	  
-                    tmp_name << "pair_flat_stat_" << c << "_" << i << "_" << j;
-                    _pair_flat[c][i*_nodes+j] = new Stats( this, tmp_name.str( ), 1.0, 250 );
-                    _stats[tmp_name.str()] = _pair_flat[c][i*_nodes+j];
-                    tmp_name.str("");
-                }
-            }
+        if(_track_stalls) {
+            _buffer_busy_stalls[c].resize(_subnets*_routers, 0);
+            _buffer_conflict_stalls[c].resize(_subnets*_routers, 0);
+            _buffer_full_stalls[c].resize(_subnets*_routers, 0);
+            _buffer_reserved_stalls[c].resize(_subnets*_routers, 0);
+            _crossbar_conflict_stalls[c].resize(_subnets*_routers, 0);
         }
     }
 
@@ -604,21 +740,16 @@ TrafficManager::~TrafficManager( )
 
         delete _traffic_pattern[c];
         delete _injection_process[c];
-        if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    delete _pair_plat[c][i*_nodes+j];
-                    delete _pair_nlat[c][i*_nodes+j];
-                    delete _pair_flat[c][i*_nodes+j];
-                }
-            }
-        }
     }
   
+    delete _trace;
+    delete _trace_hash;
+    delete _util_sampler;
+    delete _profiler;
+
     if(gWatchOut && (gWatchOut != &cout)) delete gWatchOut;
     if(_stats_out && (_stats_out != &cout)) delete _stats_out;
 
-#ifdef TRACK_FLOWS
     if(_injected_flits_out) delete _injected_flits_out;
     if(_received_flits_out) delete _received_flits_out;
     if(_stored_flits_out) delete _stored_flits_out;
@@ -626,13 +757,10 @@ TrafficManager::~TrafficManager( )
     if(_outstanding_credits_out) delete _outstanding_credits_out;
     if(_ejected_flits_out) delete _ejected_flits_out;
     if(_active_packets_out) delete _active_packets_out;
-#endif
 
-#ifdef TRACK_CREDITS
     if(_used_credits_out) delete _used_credits_out;
     if(_free_credits_out) delete _free_credits_out;
     if(_max_credits_out) delete _max_credits_out;
-#endif
 
     PacketReplyInfo::FreeAll();
     Flit::FreeAll();
@@ -644,12 +772,26 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
 {
     _deadlock_timer = 0;
 
-    assert(_total_in_flight_flits[f->cl].count(f->id) > 0);
-    _total_in_flight_flits[f->cl].erase(f->id);
+    // the copies of a multicast flit share its id, only the last one to
+    // arrive takes it out of flight
+    bool last_copy = true;
+    if(!f->mcast.empty()) {
+        map<int, int>::iterator const iter = _mcast_copies.find(f->id);
+        assert((iter != _mcast_copies.end()) && (iter->second > 0));
+        last_copy = (--iter->second == 0);
+        if(last_copy) {
+            _mcast_copies.erase(iter);
+        }
+    }
+
+    if(last_copy) {
+        assert(_total_in_flight_flits[f->cl].count(f->id) > 0);
+        _total_in_flight_flits[f->cl].erase(f->id);
   
-    if(f->record) {
-        assert(_measured_in_flight_flits[f->cl].count(f->id) > 0);
-        _measured_in_flight_flits[f->cl].erase(f->id);
+        if(f->record) {
+            assert(_measured_in_flight_flits[f->cl].count(f->id) > 0);
+            _measured_in_flight_flits[f->cl].erase(f->id);
+        }
     }
 
     if ( f->watch ) { 
@@ -675,13 +817,20 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         _slowest_flit[f->cl] = f->id;
     _flat_stats[f->cl]->AddSample( f->atime - f->itime);
     if(_pair_stats){
-        _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - f->itime );
+        _pair_lat[f->cl].AddFlit( f->src*_nodes+dest, f->atime - f->itime );
     }
       
     if ( f->tail ) {
         Flit * head;
         if(f->head) {
             head = f;
+        } else if(!f->mcast.empty()) {
+            map<pair<int, int>, Flit *>::iterator iter =
+                _mcast_heads.find(make_pair(f->pid, dest));
+            assert(iter != _mcast_heads.end());
+            head = iter->second;
+            _mcast_heads.erase(iter);
+            assert(head->head);
         } else {
             map<int, Flit *>::iterator iter = _retired_packets[f->cl].find(f->pid);
             assert(iter != _retired_packets[f->cl].end());
@@ -706,14 +855,14 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         if (f->type == Flit::READ_REQUEST || f->type == Flit::WRITE_REQUEST) {
             PacketReplyInfo* rinfo = PacketReplyInfo::New();
             rinfo->source = f->src;
-            rinfo->time = f->atime;
+            rinfo->time = _L2ReplyTime(dest, f->atime);
             rinfo->record = f->record;
             rinfo->type = f->type;
             _repliesPending[dest].push_back(rinfo);
         } else {
             if(f->type == Flit::READ_REPLY || f->type == Flit::WRITE_REPLY  ){
                 _requestsOutstanding[dest]--;
-            } else if(f->type == Flit::ANY_TYPE) {
+            } else if((f->type == Flit::ANY_TYPE) && last_copy) {
                 _requestsOutstanding[f->src]--;
             }
       
@@ -733,8 +882,8 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
             _frag_stats[f->cl]->AddSample( (f->atime - head->atime) - (f->id - head->id) );
    
             if(_pair_stats){
-                _pair_plat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->ctime );
-                _pair_nlat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->itime );
+                _pair_lat[f->cl].AddPacket( f->src*_nodes+dest, f->atime - head->ctime,
+                                            f->atime - head->itime );
             }
         }
     
@@ -745,7 +894,11 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
     }
   
     if(f->head && !f->tail) {
-        _retired_packets[f->cl].insert(make_pair(f->pid, f));
+        if(f->mcast.empty()) {
+            _retired_packets[f->cl].insert(make_pair(f->pid, f));
+        } else {
+            _mcast_heads.insert(make_pair(make_pair(f->pid, dest), f));
+        }
     } else {
         f->Free();
     }
@@ -761,6 +914,8 @@ int TrafficManager::_IssuePacket( int source, int cl )
             if(_repliesPending[source].front()->time <= _time) {
                 result = -1;
             }
+        } else if((_mshrs > 0) && (_requestsOutstanding[source] >= _mshrs)) {
+            // all MSHRs busy: the source stalls without generating requests
         } else {
       
             //produce a packet
@@ -772,7 +927,8 @@ int TrafficManager::_IssuePacket( int source, int cl )
                 _requestsOutstanding[source]++;
             }
         }
-    } else { //normal mode
+    } else if((cl != _mcast_class) ||
+              ((source >= _nodes_sm) && (source < _nodes_sm + _nodes_l2slice))) { //normal mode
         result = _injection_process[cl]->test(source) ? 1 : 0;
         _requestsOutstanding[source]++;
     } 
@@ -783,25 +939,25 @@ int TrafficManager::_IssuePacket( int source, int cl )
 }
 
 void TrafficManager::_GeneratePacket( int source, int stype, 
-                                      int cl, int time )
+                                      int cl, int time, int dest, int flits )
 {
     assert(stype!=0);
 
     Flit::FlitType packet_type = Flit::ANY_TYPE;
-    int size = _GetNextPacketSize(cl); //input size 
+    int size = (flits > 0) ? flits : _GetNextPacketSize(cl); //input size 
     int pid = _cur_pid++;
     assert(_cur_pid);
-    int packet_destination = _traffic_pattern[cl]->dest(source);
+    int packet_destination = (dest < 0) ? _traffic_pattern[cl]->dest(source) : dest;
     bool record = false;
     bool watch = gWatchOut && (_packets_to_watch.count(pid) > 0);
     if(_use_read_write[cl]){
         if(stype > 0) {
             if (stype == 1) {
                 packet_type = Flit::READ_REQUEST;
-                size = _read_request_size[cl];
+                size = (flits > 0) ? flits : _read_request_size[cl];
             } else if (stype == 2) {
                 packet_type = Flit::WRITE_REQUEST;
-                size = _write_request_size[cl];
+                size = (flits > 0) ? flits : _write_request_size[cl];
             } else {
                 ostringstream err;
                 err << "Invalid packet type: " << packet_type;
@@ -919,21 +1075,93 @@ void TrafficManager::_GeneratePacket( int source, int stype,
     }
 }
 
+void TrafficManager::_GenerateMulticast( int source, int cl, int time )
+{
+    int const first = RandomInt( _nodes_sm / _mcast_group - 1 ) * _mcast_group;
+
+    if ( _mcast_unicast ) {
+        // one packet per destination, as without multicast support
+        _requestsOutstanding[source] += _mcast_group - 1;
+        for ( int dest = first; dest < first + _mcast_group; ++dest ) {
+            _GeneratePacket( source, 1, cl, time, dest );
+        }
+        return;
+    }
+
+    list<Flit *> & pp = _partial_packets[source][cl];
+    assert( pp.empty() );
+    _GeneratePacket( source, 1, cl, time, first );
+    vector<int> dests( _mcast_group );
+    for ( int i = 0; i < _mcast_group; ++i ) {
+        dests[i] = first + i;
+    }
+    for ( list<Flit *>::iterator iter = pp.begin(); iter != pp.end(); ++iter ) {
+        (*iter)->mcast = dests;
+        _mcast_copies[(*iter)->id] = _mcast_group;
+    }
+}
+
+int TrafficManager::_L2ReplyTime( int dest, int arrival )
+{
+    int start = arrival;
+    if ( _l2_bandwidth > 0 ) {
+        // requests start in arrival order, _l2_bandwidth per cycle
+        if ( _l2_slot_time[dest] < arrival ) {
+            _l2_slot_time[dest] = arrival;
+            _l2_slot_used[dest] = 0;
+        } else if ( _l2_slot_used[dest] >= _l2_bandwidth ) {
+            ++_l2_slot_time[dest];
+            _l2_slot_used[dest] = 0;
+        }
+        start = _l2_slot_time[dest];
+        ++_l2_slot_used[dest];
+    }
+    return start + _l2_latency;
+}
+
+Credit * TrafficManager::_ReleaseCredits( int node, int subnet )
+{
+    deque<int> & held = _held_credits[node][subnet];
+    if ( held.empty() ||
+         ( !_empty_network &&
+           ( (int)_repliesPending[node].size() >= _l2_queue_size ) ) ) {
+        return NULL;
+    }
+    Credit * const c = Credit::New();
+    for ( ; !held.empty(); held.pop_front() ) {
+        c->AddVC( held.front() );
+        --_held_flits;
+    }
+    return c;
+}
+
 void TrafficManager::_Inject(){
 
+    if ( _trace ) {
+        _trace->Fill( _time );
+    }
+
     for ( int input = 0; input < _nodes; ++input ) {
         for ( int c = 0; c < _classes; ++c ) {
             // Potentially generate packets for any (input,class)
             // that is currently empty
             if ( _partial_packets[input][c].empty() ) {
+                if ( _trace && ( c == _trace_class ) ) {
+                    _InjectTrace( input, c );
+                    continue;
+                }
                 bool generated = false;
                 while( !generated && ( _qtime[input][c] <= _time ) ) {
                     int stype = _IssuePacket( input, c );
 	  
                     if ( stype != 0 ) { //generate a packet
-                        _GeneratePacket( input, stype, c, 
-                                         _include_queuing==1 ? 
-                                         _qtime[input][c] : _time );
+                        int const time = _include_queuing==1 ? 
+                            _qtime[input][c] : _time;
+                        if ( c == _mcast_class ) {
+                            _GenerateMulticast( input, c, time );
+                        } else {
+                            _GeneratePacket( input, stype, c, time );
+                        }
                         generated = true;
                     }
                     // only advance time if this is not a reply packet
@@ -951,6 +1179,44 @@ void TrafficManager::_Inject(){
     }
 }
 
+void TrafficManager::_InjectTrace( int source, int cl )
+{
+    // due replies go first, as in _IssuePacket; L2 slices only send those
+    MemoryTrace::Record r;
+    if ( _use_read_write[cl] && !_repliesPending[source].empty() ) {
+        if ( _repliesPending[source].front()->time <= _time ) {
+            _packet_seq_no[source]++;
+            _GeneratePacket( source, -1, cl, _time );
+        }
+    } else if ( ( source < _nodes_sm ) &&
+                ( !_use_read_write[cl] || ( _mshrs <= 0 ) ||
+                  ( _requestsOutstanding[source] < _mshrs ) ) &&
+                _trace->Next( source, _time, r ) ) {
+        int const dest = _nodes_sm + _trace_hash->Slice( r.addr );
+        int size = -1;
+        if ( ( _flit_width > 0 ) && ( r.write || !_use_read_write[cl] ) ) {
+            // data travels with writes and with plain requests; reads
+            // return a full line
+            size = _BytesToFlits( _header_bytes + r.size );
+        }
+        _requestsOutstanding[source]++;
+        _packet_seq_no[source]++;
+        _GeneratePacket( source, r.write ? 2 : 1, cl,
+                         _include_queuing==1 ? (int)r.cycle : _time,
+                         dest, size );
+    }
+
+    // queue time is the issue cycle of the next record, past any drain
+    // time once there are no more records for this source
+    long long const next = ( source < _nodes_sm ) ? _trace->NextCycle( source ) : -1;
+    _qtime[source][cl] = ( next < 0 ) ? numeric_limits<int>::max() :
+        (int)min( next, (long long)numeric_limits<int>::max() );
+    if ( ( _sim_state == draining ) && 
+         ( _qtime[source][cl] > _drain_time ) ) {
+        _qdrained[source][cl] = true;
+    }
+}
+
 void TrafficManager::_Step( )
 {
     bool flits_in_flight = false;
@@ -962,6 +1228,42 @@ void TrafficManager::_Step( )
         cout << "WARNING: Possible network deadlock.\n";
     }
 
+    // with no flits in flight and no credits outstanding the network is
+    // quiescent, so only the sources need to be polled until one of them
+    // generates a packet; polling them every cycle keeps the random stream
+    // and the injection times identical to cycle-by-cycle stepping
+    if ( _fast_forward && !flits_in_flight && ( Credit::OutStanding() == 0 ) &&
+         ( _held_flits == 0 ) ) {
+        unsigned long long const t = _profiler ? Profiler::Ticks() : 0;
+        if ( !_empty_network ) {
+            _Inject();
+        }
+        if ( _profiler ) {
+            _profiler->Lap( prof_inject, t );
+        }
+        bool injected = false;
+        for(int c = 0; c < _classes; ++c) {
+            injected |= !_total_in_flight_flits[c].empty();
+        }
+        if ( !injected ) {
+            ++_time;
+            assert(_time);
+            if ( _profiler ) {
+                _profiler->Cycle();
+            }
+            if(gTrace){
+                cout<<"TIME "<<_time<<endl;
+            }
+            if ( _util_sampler && ( _time % _util_sampler->Period() == 0 ) ) {
+                _util_sampler->Sample( _time );
+            }
+            return;
+        }
+        // the second _Inject() below is a no-op for this cycle
+    }
+
+    unsigned long long t = _profiler ? Profiler::Ticks() : 0;
+
     vector<map<int, Flit *> > flits(_subnets);
   
     for ( int subnet = 0; subnet < _subnets; ++subnet ) {
@@ -987,21 +1289,28 @@ void TrafficManager::_Step( )
 
             Credit * const c = _net[subnet]->ReadCredit( n );
             if ( c ) {
-#ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-                    int const vc = *iter;
-                    assert(!_outstanding_classes[n][subnet][vc].empty());
-                    int cl = _outstanding_classes[n][subnet][vc].front();
-                    _outstanding_classes[n][subnet][vc].pop();
-                    assert(_outstanding_credits[cl][subnet][n] > 0);
-                    --_outstanding_credits[cl][subnet][n];
+                if(_track_flows) {
+                    for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
+                        for(int slot = 0; slot < c->Count(vc); ++slot) {
+                            assert(!_outstanding_classes[n][subnet][vc].empty());
+                            int cl = _outstanding_classes[n][subnet][vc].front();
+                            _outstanding_classes[n][subnet][vc].pop();
+                            assert(_outstanding_credits[cl][subnet][n] > 0);
+                            --_outstanding_credits[cl][subnet][n];
+                        }
+                    }
                 }
-#endif
                 _buf_states[n][subnet]->ProcessCredit(c);
                 c->Free();
             }
         }
+        if ( _profiler ) {
+            t = _profiler->Lap( prof_eject, t );
+        }
         _net[subnet]->ReadInputs( );
+        if ( _profiler ) {
+            t = _profiler->Lap( prof_read_inputs, t );
+        }
     }
   
     if ( !_empty_network ) {
@@ -1059,9 +1368,8 @@ void TrafficManager::_Step( )
 	  
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);
-                    set<OutputSet::sSetElement> const & os = route_set.GetSet();
-                    assert(os.size() == 1);
-                    OutputSet::sSetElement const & se = *os.begin();
+                    assert(route_set.Size() == 1);
+                    OutputSet::sSetElement const & se = *route_set.begin();
                     assert(se.output_port == -1);
                     int vc_start = se.vc_start;
                     int vc_end = se.vc_end;
@@ -1086,9 +1394,8 @@ void TrafficManager::_Step( )
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
-                        assert(sl.size() == 1);
-                        int next_output = sl.begin()->output_port;
+                        assert(cf->la_route_set.Size() == 1);
+                        int next_output = cf->la_route_set.begin()->output_port;
                         vc_count /= router->NumOutputs();
                         vc_start += next_output * vc_count;
                         vc_end = vc_start + vc_count - 1;
@@ -1190,10 +1497,10 @@ void TrafficManager::_Step( )
 
                 _partial_packets[n][c].pop_front();
 
-#ifdef TRACK_FLOWS
-                ++_outstanding_credits[c][subnet][n];
-                _outstanding_classes[n][subnet][f->vc].push(c);
-#endif
+                if(_track_flows) {
+                    ++_outstanding_credits[c][subnet][n];
+                    _outstanding_classes[n][subnet][f->vc].push(c);
+                }
 
                 dest_buf->SendingFlit(f);
 	
@@ -1226,51 +1533,84 @@ void TrafficManager::_Step( )
                     }
                 }
 	
-#ifdef TRACK_FLOWS
-                ++_injected_flits[c][n];
-#endif
+                if(_track_flows) {
+                    ++_injected_flits[c][n];
+                }
 	
                 _net[subnet]->WriteFlit(f, n);
 	
             }
         }
     }
+    if ( _profiler ) {
+        t = _profiler->Lap( prof_inject, t );
+    }
 
     for(int subnet = 0; subnet < _subnets; ++subnet) {
         for(int n = 0; n < _nodes; ++n) {
+            Credit * c = (_l2_queue_size > 0) ? _ReleaseCredits(n, subnet) : NULL;
             map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
             if(iter != flits[subnet].end()) {
                 Flit * const f = iter->second;
 
                 f->atime = _time;
-                if(f->watch) {
-                    *gWatchOut << GetSimTime() << " | "
-                               << "node" << n << " | "
-                               << "Injecting credit for VC " << f->vc 
-                               << " into subnet " << subnet 
-                               << "." << endl;
+                if((_l2_queue_size > 0) && !_empty_network &&
+                   ((f->type == Flit::READ_REQUEST) || (f->type == Flit::WRITE_REQUEST)) &&
+                   ((int)_repliesPending[n].size() >= _l2_queue_size)) {
+                    // destination queue is full: the credit is returned
+                    // once a reply has left
+                    _held_credits[n][subnet].push_back(f->vc);
+                    ++_held_flits;
+                } else {
+                    if(f->watch) {
+                        *gWatchOut << GetSimTime() << " | "
+                                   << "node" << n << " | "
+                                   << "Injecting credit for VC " << f->vc 
+                                   << " into subnet " << subnet 
+                                   << "." << endl;
+                    }
+                    if(!c) {
+                        c = Credit::New();
+                    }
+                    c->AddVC(f->vc);
                 }
-                Credit * const c = Credit::New();
-                c->vc.insert(f->vc);
-                _net[subnet]->WriteCredit(c, n);
 	
-#ifdef TRACK_FLOWS
-                ++_ejected_flits[f->cl][n];
-#endif
+                if(_track_flows) {
+                    ++_ejected_flits[f->cl][n];
+                }
 	
                 _RetireFlit(f, n);
             }
+            if(c) {
+                _net[subnet]->WriteCredit(c, n);
+            }
+        }
+        if ( _profiler ) {
+            _profiler->Flits( flits[subnet].size() );
+            t = _profiler->Lap( prof_retire, t );
         }
         flits[subnet].clear();
         _net[subnet]->Evaluate( );
+        if ( _profiler ) {
+            t = _profiler->Lap( prof_evaluate, t );
+        }
         _net[subnet]->WriteOutputs( );
+        if ( _profiler ) {
+            t = _profiler->Lap( prof_write_outputs, t );
+        }
     }
 
     ++_time;
     assert(_time);
+    if ( _profiler ) {
+        _profiler->Cycle();
+    }
     if(gTrace){
         cout<<"TIME "<<_time<<endl;
     }
+    if ( _util_sampler && ( _time % _util_sampler->Period() == 0 ) ) {
+        _util_sampler->Sample( _time );
+    }
 
 }
   
@@ -1318,21 +1658,15 @@ void TrafficManager::_ClearStats( )
         _sent_flits[c].assign(_nodes, 0);
         _accepted_flits[c].assign(_nodes, 0);
 
-#ifdef TRACK_STALLS
-        _buffer_busy_stalls[c].assign(_subnets*_routers, 0);
-        _buffer_conflict_stalls[c].assign(_subnets*_routers, 0);
-        _buffer_full_stalls[c].assign(_subnets*_routers, 0);
-        _buffer_reserved_stalls[c].assign(_subnets*_routers, 0);
-        _crossbar_conflict_stalls[c].assign(_subnets*_routers, 0);
-#endif
+        if(_track_stalls) {
+            _buffer_busy_stalls[c].assign(_subnets*_routers, 0);
+            _buffer_conflict_stalls[c].assign(_subnets*_routers, 0);
+            _buffer_full_stalls[c].assign(_subnets*_routers, 0);
+            _buffer_reserved_stalls[c].assign(_subnets*_routers, 0);
+            _crossbar_conflict_stalls[c].assign(_subnets*_routers, 0);
+        }
         if(_pair_stats){
-            for ( int i = 0; i < _nodes; ++i ) {
-                for ( int j = 0; j < _nodes; ++j ) {
-                    _pair_plat[c][i*_nodes+j]->Clear( );
-                    _pair_nlat[c][i*_nodes+j]->Clear( );
-                    _pair_flat[c][i*_nodes+j]->Clear( );
-                }
-            }
+            _pair_lat[c].Clear( );
         }
         _hop_stats[c]->Clear();
 
@@ -1414,6 +1748,161 @@ void TrafficManager::_DisplayRemaining( ostream & os ) const
     }
 }
 
+void TrafficManager::_SaveCheckpoint( int total_phases, vector<double> const & prev_latency,
+                                      vector<double> const & prev_accepted ) const
+{
+    ofstream os( _checkpoint_out.c_str( ), ios::binary );
+    if ( !os ) {
+        Error( "Cannot open checkpoint file " + _checkpoint_out );
+    }
+    CheckpointWriter w( os );
+
+    w.Section( "booksim checkpoint v1" );
+    w.Write( _nodes );
+    w.Write( _classes );
+    w.Write( _subnets );
+    w.Write( (int)_track_flows );
+    w.Write( (int)_track_stalls );
+    w.Write( (int)_track_buffers );
+
+    w.Write( total_phases );
+    w.Write( prev_latency );
+    w.Write( prev_accepted );
+
+    w.Write( _time );
+    w.Write( _cur_id );
+    w.Write( _cur_pid );
+    w.Write( _drain_time );
+    w.Write( _empty_network );
+    w.Write( _deadlock_timer );
+    w.Write( _last_class );
+    w.Write( _last_vc );
+    w.Write( _qtime );
+    w.Write( _qdrained );
+    w.Write( _partial_packets );
+    w.Write( _total_in_flight_flits );
+    w.Write( _measured_in_flight_flits );
+    w.Write( _retired_packets );
+    w.Write( _packet_seq_no );
+    w.Write( _repliesPending );
+    w.Write( _requestsOutstanding );
+    w.Write( _l2_slot_time );
+    w.Write( _l2_slot_used );
+    w.Write( _held_credits );
+    w.Write( _held_flits );
+    if(_track_flows) {
+        w.Write( _outstanding_credits );
+        w.Write( _outstanding_classes );
+        w.Write( _injected_flits );
+        w.Write( _ejected_flits );
+    }
+
+    for ( int c = 0; c < _classes; ++c ) {
+        _traffic_pattern[c]->Save( w );
+        _injection_process[c]->Save( w );
+    }
+    if ( _trace ) {
+        _trace->Save( w );
+    }
+
+    vector<long> rand_l;
+    vector<double> rand_d;
+    SaveRandomStream( rand_l, rand_d );
+    w.Write( rand_l );
+    w.Write( rand_d );
+
+    for ( int s = 0; s < _subnets; ++s ) {
+        for ( int n = 0; n < _nodes; ++n ) {
+            _buf_states[n][s]->Save( w );
+        }
+        _net[s]->Save( w );
+    }
+
+    if ( !os ) {
+        Error( "Cannot write checkpoint file " + _checkpoint_out );
+    }
+    cout << "Checkpoint written to " << _checkpoint_out << endl;
+}
+
+void TrafficManager::_LoadCheckpoint( int & total_phases, vector<double> & prev_latency,
+                                      vector<double> & prev_accepted )
+{
+    ifstream is( _checkpoint_in.c_str( ), ios::binary );
+    if ( !is ) {
+        Error( "Cannot open checkpoint file " + _checkpoint_in );
+    }
+    CheckpointReader r( is );
+
+    r.Section( "booksim checkpoint v1" );
+    r.Expect( _nodes, "number of nodes" );
+    r.Expect( _classes, "number of classes" );
+    r.Expect( _subnets, "number of subnets" );
+    r.Expect( _track_flows, "track_flows" );
+    r.Expect( _track_stalls, "track_stalls" );
+    r.Expect( _track_buffers, "track_buffers" );
+
+    r.Read( total_phases );
+    r.Read( prev_latency );
+    r.Read( prev_accepted );
+
+    r.Read( _time );
+    r.Read( _cur_id );
+    r.Read( _cur_pid );
+    r.Read( _drain_time );
+    r.Read( _empty_network );
+    r.Read( _deadlock_timer );
+    r.Read( _last_class );
+    r.Read( _last_vc );
+    r.Read( _qtime );
+    r.Read( _qdrained );
+    r.Read( _partial_packets );
+    r.Read( _total_in_flight_flits );
+    r.Read( _measured_in_flight_flits );
+    r.Read( _retired_packets );
+    r.Read( _packet_seq_no );
+    r.Read( _repliesPending );
+    r.Read( _requestsOutstanding );
+    r.Read( _l2_slot_time );
+    r.Read( _l2_slot_used );
+    r.Read( _held_credits );
+    r.Read( _held_flits );
+    if(_track_flows) {
+        r.Read( _outstanding_credits );
+        r.Read( _outstanding_classes );
+        r.Read( _injected_flits );
+        r.Read( _ejected_flits );
+    }
+
+    for ( int c = 0; c < _classes; ++c ) {
+        _traffic_pattern[c]->Load( r );
+        _injection_process[c]->Load( r );
+    }
+    if ( _trace ) {
+        _trace->Load( r );
+    }
+
+    vector<long> rand_l;
+    vector<double> rand_d;
+    r.Read( rand_l );
+    r.Read( rand_d );
+    RestoreRandomStream( rand_l, rand_d );
+
+    for ( int s = 0; s < _subnets; ++s ) {
+        for ( int n = 0; n < _nodes; ++n ) {
+            _buf_states[n][s]->Load( r );
+        }
+        _net[s]->Load( r );
+    }
+
+    // watch lists belong to this run, not to the one that wrote the snapshot
+    vector<Flit *> const & flits = r.Flits( );
+    for ( size_t i = 0; i < flits.size( ); ++i ) {
+        Flit * const f = flits[i];
+        f->watch = gWatchOut && ( ( _flits_to_watch.count( f->id ) > 0 ) ||
+                                  ( _packets_to_watch.count( f->pid ) > 0 ) );
+    }
+}
+
 bool TrafficManager::_SingleSim( )
 {
     int converged = 0;
@@ -1423,6 +1912,14 @@ bool TrafficManager::_SingleSim( )
     vector<double> prev_accepted(_classes, 0.0);
     bool clear_last = false;
     int total_phases = 0;
+
+    if ( !_checkpoint_in.empty( ) ) {
+        _LoadCheckpoint( total_phases, prev_latency, prev_accepted );
+        _checkpoint_in.clear( );
+        cout << "Restored checkpoint ..." << "Time used is " << _time << " cycles" << endl;
+        clear_last = true;
+        _sim_state = running;
+    }
     while( ( total_phases < _max_samples ) && 
            ( ( _sim_state != running ) || 
              ( converged < 3 ) ) ) {
@@ -1541,6 +2038,11 @@ bool TrafficManager::_SingleSim( )
             }
         }
         ++total_phases;
+
+        if ( clear_last && !_checkpoint_out.empty( ) ) {
+            _SaveCheckpoint( total_phases, prev_latency, prev_accepted );
+            _checkpoint_out.clear( );
+        }
     }
   
     if ( _sim_state == running ) {
@@ -1616,6 +2118,8 @@ bool TrafficManager::Run( )
 
         //remove any pending request from the previous simulations
         _requestsOutstanding.assign(_nodes, 0);
+        _l2_slot_time.assign(_nodes, 0);
+        _l2_slot_used.assign(_nodes, 0);
         for (int i=0;i<_nodes;i++) {
             while(!_repliesPending[i].empty()) {
                 _repliesPending[i].front()->Free();
@@ -1641,9 +2145,13 @@ bool TrafficManager::Run( )
             _traffic_pattern[c]->reset();
             _injection_process[c]->reset();
         }
+        if ( _trace ) {
+            _trace->Reset( );
+        }
 
         if ( !_SingleSim( ) ) {
             cout << "Simulation unstable, ending ..." << endl;
+            _DisplayProfile( );
             return false;
         }
 
@@ -1691,10 +2199,37 @@ bool TrafficManager::Run( )
     if(_print_csv_results) {
         DisplayOverallStatsCSV();
     }
+    _DisplayProfile( );
   
     return true;
 }
 
+void TrafficManager::_DisplayProfile( ) const
+{
+    if ( !_profiler ) {
+        return;
+    }
+    vector<string> stages;
+    vector<unsigned long long> stage_ticks;
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+        for ( size_t r = 0; r < _router[subnet].size(); ++r ) {
+            IQRouter const * const iq = dynamic_cast<IQRouter const *>( _router[subnet][r] );
+            if ( !iq ) {
+                continue;
+            }
+            vector<unsigned long long> const & ticks = iq->GetStageTicks();
+            if ( stage_ticks.empty() ) {
+                stages.assign( IQRouter::STAGE, IQRouter::STAGE + ticks.size() );
+                stage_ticks.resize( ticks.size(), 0 );
+            }
+            for ( size_t i = 0; i < ticks.size(); ++i ) {
+                stage_ticks[i] += ticks[i];
+            }
+        }
+    }
+    _profiler->Display( cout, stages, stage_ticks );
+}
+
 void TrafficManager::_UpdateOverallStats() {
     for ( int c = 0; c < _classes; ++c ) {
     
@@ -1711,6 +2246,11 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_min_flat[c] += _flat_stats[c]->Min();
         _overall_avg_flat[c] += _flat_stats[c]->Average();
         _overall_max_flat[c] += _flat_stats[c]->Max();
+        for ( int i = 0; i < gNumTailPercentiles; ++i ) {
+            _overall_tail_plat[c][i] += _plat_stats[c]->Percentile( gTailPercentiles[i] );
+            _overall_tail_nlat[c][i] += _nlat_stats[c]->Percentile( gTailPercentiles[i] );
+            _overall_tail_flat[c][i] += _flat_stats[c]->Percentile( gTailPercentiles[i] );
+        }
     
         _overall_min_frag[c] += _frag_stats[c]->Min();
         _overall_avg_frag[c] += _frag_stats[c]->Average();
@@ -1755,28 +2295,28 @@ void TrafficManager::_UpdateOverallStats() {
         _overall_avg_accepted_packets[c] += rate_avg;
         _overall_max_accepted_packets[c] += rate_max;
 
-#ifdef TRACK_STALLS
-        _ComputeStats(_buffer_busy_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_busy_stalls[c] += rate_avg;
-        _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_conflict_stalls[c] += rate_avg;
-        _ComputeStats(_buffer_full_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_full_stalls[c] += rate_avg;
-        _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_buffer_reserved_stalls[c] += rate_avg;
-        _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        _overall_crossbar_conflict_stalls[c] += rate_avg;
-#endif
+        if(_track_stalls) {
+            _ComputeStats(_buffer_busy_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_busy_stalls[c] += rate_avg;
+            _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_conflict_stalls[c] += rate_avg;
+            _ComputeStats(_buffer_full_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_full_stalls[c] += rate_avg;
+            _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_buffer_reserved_stalls[c] += rate_avg;
+            _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            _overall_crossbar_conflict_stalls[c] += rate_avg;
+        }
 
     }
 }
@@ -1798,34 +2338,40 @@ void TrafficManager::WriteStats(ostream & os) const {
            << "nlat_hist(" << c+1 << ",:) = " << *_nlat_stats[c] << ";" << endl
            << "flat(" << c+1 << ") = " << _flat_stats[c]->Average() << ";" << endl
            << "flat_hist(" << c+1 << ",:) = " << *_flat_stats[c] << ";" << endl
-           << "frag_hist(" << c+1 << ",:) = " << *_frag_stats[c] << ";" << endl
-           << "hops(" << c+1 << ",:) = " << *_hop_stats[c] << ";" << endl;
+           << "frag_hist(" << c+1 << ",:) = " << *_frag_stats[c] << ";" << endl;
+        _WriteTail(os, "plat_tail", c, _plat_stats[c]);
+        _WriteTail(os, "nlat_tail", c, _nlat_stats[c]);
+        _WriteTail(os, "flat_tail", c, _flat_stats[c]);
+        os << "hops(" << c+1 << ",:) = " << *_hop_stats[c] << ";" << endl;
         if(_pair_stats){
             os<< "pair_sent(" << c+1 << ",:) = [ ";
             for(int i = 0; i < _nodes; ++i) {
                 for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_plat[c][i*_nodes+j]->NumSamples() << " ";
+                    os << _pair_lat[c].Find(i*_nodes+j).packets << " ";
                 }
             }
             os << "];" << endl
                << "pair_plat(" << c+1 << ",:) = [ ";
             for(int i = 0; i < _nodes; ++i) {
                 for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_plat[c][i*_nodes+j]->Average( ) << " ";
+                    PairStats::Entry const & e = _pair_lat[c].Find(i*_nodes+j);
+                    os << e.plat_sum / (double)e.packets << " ";
                 }
             }
             os << "];" << endl
                << "pair_nlat(" << c+1 << ",:) = [ ";
             for(int i = 0; i < _nodes; ++i) {
                 for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_nlat[c][i*_nodes+j]->Average( ) << " ";
+                    PairStats::Entry const & e = _pair_lat[c].Find(i*_nodes+j);
+                    os << e.nlat_sum / (double)e.packets << " ";
                 }
             }
             os << "];" << endl
                << "pair_flat(" << c+1 << ",:) = [ ";
             for(int i = 0; i < _nodes; ++i) {
                 for(int j = 0; j < _nodes; ++j) {
-                    os << _pair_flat[c][i*_nodes+j]->Average( ) << " ";
+                    PairStats::Entry const & e = _pair_lat[c].Find(i*_nodes+j);
+                    os << e.flat_sum / (double)e.flits << " ";
                 }
             }
         }
@@ -1863,110 +2409,108 @@ void TrafficManager::WriteStats(ostream & os) const {
             os << (double)_accepted_flits[c][d] / (double)_accepted_packets[c][d] << " ";
         }
         os << "];" << endl;
-#ifdef TRACK_STALLS
-        os << "buffer_busy_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_busy_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "buffer_conflict_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_conflict_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "buffer_full_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_full_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "buffer_reserved_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_buffer_reserved_stalls[c][d] / time_delta << " ";
-        }
-        os << "];" << endl
-           << "crossbar_conflict_stalls(" << c+1 << ",:) = [ ";
-        for ( int d = 0; d < _subnets*_routers; ++d ) {
-            os << (double)_crossbar_conflict_stalls[c][d] / time_delta << " ";
+        if(_track_stalls) {
+            os << "buffer_busy_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_busy_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "buffer_conflict_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_conflict_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "buffer_full_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_full_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "buffer_reserved_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_buffer_reserved_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl
+               << "crossbar_conflict_stalls(" << c+1 << ",:) = [ ";
+            for ( int d = 0; d < _subnets*_routers; ++d ) {
+                os << (double)_crossbar_conflict_stalls[c][d] / time_delta << " ";
+            }
+            os << "];" << endl;
         }
-        os << "];" << endl;
-#endif
     }
 }
 
 void TrafficManager::UpdateStats() {
-#if defined(TRACK_FLOWS) || defined(TRACK_STALLS)
-    for(int c = 0; c < _classes; ++c) {
-#ifdef TRACK_FLOWS
-        {
-            char trail_char = (c == _classes - 1) ? '\n' : ',';
-            if(_injected_flits_out) *_injected_flits_out << _injected_flits[c] << trail_char;
-            _injected_flits[c].assign(_nodes, 0);
-            if(_ejected_flits_out) *_ejected_flits_out << _ejected_flits[c] << trail_char;
-            _ejected_flits[c].assign(_nodes, 0);
-        }
-#endif
-        for(int subnet = 0; subnet < _subnets; ++subnet) {
-#ifdef TRACK_FLOWS
-            if(_outstanding_credits_out) *_outstanding_credits_out << _outstanding_credits[c][subnet] << ',';
-            if(_stored_flits_out) *_stored_flits_out << vector<int>(_nodes, 0) << ',';
-#endif
-            for(int router = 0; router < _routers; ++router) {
-                Router * const r = _router[subnet][router];
-#ifdef TRACK_FLOWS
-                char trail_char = 
-                    ((router == _routers - 1) && (subnet == _subnets - 1) && (c == _classes - 1)) ? '\n' : ',';
-                if(_received_flits_out) *_received_flits_out << r->GetReceivedFlits(c) << trail_char;
-                if(_stored_flits_out) *_stored_flits_out << r->GetStoredFlits(c) << trail_char;
-                if(_sent_flits_out) *_sent_flits_out << r->GetSentFlits(c) << trail_char;
-                if(_outstanding_credits_out) *_outstanding_credits_out << r->GetOutstandingCredits(c) << trail_char;
-                if(_active_packets_out) *_active_packets_out << r->GetActivePackets(c) << trail_char;
-                r->ResetFlowStats(c);
-#endif
-#ifdef TRACK_STALLS
-                _buffer_busy_stalls[c][subnet*_routers+router] += r->GetBufferBusyStalls(c);
-                _buffer_conflict_stalls[c][subnet*_routers+router] += r->GetBufferConflictStalls(c);
-                _buffer_full_stalls[c][subnet*_routers+router] += r->GetBufferFullStalls(c);
-                _buffer_reserved_stalls[c][subnet*_routers+router] += r->GetBufferReservedStalls(c);
-                _crossbar_conflict_stalls[c][subnet*_routers+router] += r->GetCrossbarConflictStalls(c);
-                r->ResetStallStats(c);
-#endif
+    if(_track_flows || _track_stalls) {
+        for(int c = 0; c < _classes; ++c) {
+            if(_track_flows) {
+                char trail_char = (c == _classes - 1) ? '\n' : ',';
+                if(_injected_flits_out) *_injected_flits_out << _injected_flits[c] << trail_char;
+                _injected_flits[c].assign(_nodes, 0);
+                if(_ejected_flits_out) *_ejected_flits_out << _ejected_flits[c] << trail_char;
+                _ejected_flits[c].assign(_nodes, 0);
             }
-        }
-    }
-#ifdef TRACK_FLOWS
-    if(_injected_flits_out) *_injected_flits_out << flush;
-    if(_received_flits_out) *_received_flits_out << flush;
-    if(_stored_flits_out) *_stored_flits_out << flush;
-    if(_sent_flits_out) *_sent_flits_out << flush;
-    if(_outstanding_credits_out) *_outstanding_credits_out << flush;
-    if(_ejected_flits_out) *_ejected_flits_out << flush;
-    if(_active_packets_out) *_active_packets_out << flush;
-#endif
-#endif
-
-#ifdef TRACK_CREDITS
-    for(int s = 0; s < _subnets; ++s) {
-        for(int n = 0; n < _nodes; ++n) {
-            BufferState const * const bs = _buf_states[n][s];
-            for(int v = 0; v < _vcs; ++v) {
-                if(_used_credits_out) *_used_credits_out << bs->OccupancyFor(v) << ',';
-                if(_free_credits_out) *_free_credits_out << bs->AvailableFor(v) << ',';
-                if(_max_credits_out) *_max_credits_out << bs->LimitFor(v) << ',';
+            for(int subnet = 0; subnet < _subnets; ++subnet) {
+                if(_track_flows) {
+                    if(_outstanding_credits_out) *_outstanding_credits_out << _outstanding_credits[c][subnet] << ',';
+                    if(_stored_flits_out) *_stored_flits_out << vector<int>(_nodes, 0) << ',';
+                }
+                for(int router = 0; router < _routers; ++router) {
+                    Router * const r = _router[subnet][router];
+                    if(_track_flows) {
+                        char trail_char = 
+                            ((router == _routers - 1) && (subnet == _subnets - 1) && (c == _classes - 1)) ? '\n' : ',';
+                        if(_received_flits_out) *_received_flits_out << r->GetReceivedFlits(c) << trail_char;
+                        if(_stored_flits_out) *_stored_flits_out << r->GetStoredFlits(c) << trail_char;
+                        if(_sent_flits_out) *_sent_flits_out << r->GetSentFlits(c) << trail_char;
+                        if(_outstanding_credits_out) *_outstanding_credits_out << r->GetOutstandingCredits(c) << trail_char;
+                        if(_active_packets_out) *_active_packets_out << r->GetActivePackets(c) << trail_char;
+                        r->ResetFlowStats(c);
+                    }
+                    if(_track_stalls) {
+                        _buffer_busy_stalls[c][subnet*_routers+router] += r->GetBufferBusyStalls(c);
+                        _buffer_conflict_stalls[c][subnet*_routers+router] += r->GetBufferConflictStalls(c);
+                        _buffer_full_stalls[c][subnet*_routers+router] += r->GetBufferFullStalls(c);
+                        _buffer_reserved_stalls[c][subnet*_routers+router] += r->GetBufferReservedStalls(c);
+                        _crossbar_conflict_stalls[c][subnet*_routers+router] += r->GetCrossbarConflictStalls(c);
+                        r->ResetStallStats(c);
+                    }
+                }
             }
         }
-        for(int r = 0; r < _routers; ++r) {
-            Router const * const rtr = _router[s][r];
-            char trail_char = 
-                ((r == _routers - 1) && (s == _subnets - 1)) ? '\n' : ',';
-            if(_used_credits_out) *_used_credits_out << rtr->UsedCredits() << trail_char;
-            if(_free_credits_out) *_free_credits_out << rtr->FreeCredits() << trail_char;
-            if(_max_credits_out) *_max_credits_out << rtr->MaxCredits() << trail_char;
+        if(_track_flows) {
+            if(_injected_flits_out) *_injected_flits_out << flush;
+            if(_received_flits_out) *_received_flits_out << flush;
+            if(_stored_flits_out) *_stored_flits_out << flush;
+            if(_sent_flits_out) *_sent_flits_out << flush;
+            if(_outstanding_credits_out) *_outstanding_credits_out << flush;
+            if(_ejected_flits_out) *_ejected_flits_out << flush;
+            if(_active_packets_out) *_active_packets_out << flush;
+        }
+    }
+
+    if(_track_credits) {
+        for(int s = 0; s < _subnets; ++s) {
+            for(int n = 0; n < _nodes; ++n) {
+                BufferState const * const bs = _buf_states[n][s];
+                for(int v = 0; v < _vcs; ++v) {
+                    if(_used_credits_out) *_used_credits_out << bs->OccupancyFor(v) << ',';
+                    if(_free_credits_out) *_free_credits_out << bs->AvailableFor(v) << ',';
+                    if(_max_credits_out) *_max_credits_out << bs->LimitFor(v) << ',';
+                }
+            }
+            for(int r = 0; r < _routers; ++r) {
+                Router const * const rtr = _router[s][r];
+                char trail_char = 
+                    ((r == _routers - 1) && (s == _subnets - 1)) ? '\n' : ',';
+                if(_used_credits_out) *_used_credits_out << rtr->UsedCredits() << trail_char;
+                if(_free_credits_out) *_free_credits_out << rtr->FreeCredits() << trail_char;
+                if(_max_credits_out) *_max_credits_out << rtr->MaxCredits() << trail_char;
+            }
         }
+        if(_used_credits_out) *_used_credits_out << flush;
+        if(_free_credits_out) *_free_credits_out << flush;
+        if(_max_credits_out) *_max_credits_out << flush;
     }
-    if(_used_credits_out) *_used_credits_out << flush;
-    if(_free_credits_out) *_free_credits_out << flush;
-    if(_max_credits_out) *_max_credits_out << flush;
-#endif
 
 }
 
@@ -1983,14 +2527,20 @@ void TrafficManager::DisplayStats(ostream & os) const {
         cout 
             << "Packet latency average = " << _plat_stats[c]->Average() << endl
             << "\tminimum = " << _plat_stats[c]->Min() << endl
-            << "\tmaximum = " << _plat_stats[c]->Max() << endl
+            << "\tmaximum = " << _plat_stats[c]->Max() << endl;
+        _DisplayTail(cout, _plat_stats[c]);
+        cout
             << "Network latency average = " << _nlat_stats[c]->Average() << endl
             << "\tminimum = " << _nlat_stats[c]->Min() << endl
-            << "\tmaximum = " << _nlat_stats[c]->Max() << endl
+            << "\tmaximum = " << _nlat_stats[c]->Max() << endl;
+        _DisplayTail(cout, _nlat_stats[c]);
+        cout
             << "Slowest packet = " << _slowest_packet[c] << endl
             << "Flit latency average = " << _flat_stats[c]->Average() << endl
             << "\tminimum = " << _flat_stats[c]->Min() << endl
-            << "\tmaximum = " << _flat_stats[c]->Max() << endl
+            << "\tmaximum = " << _flat_stats[c]->Max() << endl;
+        _DisplayTail(cout, _flat_stats[c]);
+        cout
             << "Slowest flit = " << _slowest_flit[c] << endl
             << "Fragmentation average = " << _frag_stats[c]->Average() << endl
             << "\tminimum = " << _frag_stats[c]->Min() << endl
@@ -2054,28 +2604,28 @@ void TrafficManager::DisplayStats(ostream & os) const {
              << " (" << _measured_in_flight_flits[c].size() << " measured)"
              << endl;
     
-#ifdef TRACK_STALLS
-        _ComputeStats(_buffer_busy_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer busy stall rate = " << rate_avg << endl;
-        _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer conflict stall rate = " << rate_avg << endl;
-        _ComputeStats(_buffer_full_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer full stall rate = " << rate_avg << endl;
-        _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Buffer reserved stall rate = " << rate_avg << endl;
-        _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
-        rate_sum = (double)count_sum / time_delta;
-        rate_avg = rate_sum / (double)(_subnets*_routers);
-        os << "Crossbar conflict stall rate = " << rate_avg << endl;
-#endif
+        if(_track_stalls) {
+            _ComputeStats(_buffer_busy_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer busy stall rate = " << rate_avg << endl;
+            _ComputeStats(_buffer_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer conflict stall rate = " << rate_avg << endl;
+            _ComputeStats(_buffer_full_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer full stall rate = " << rate_avg << endl;
+            _ComputeStats(_buffer_reserved_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Buffer reserved stall rate = " << rate_avg << endl;
+            _ComputeStats(_crossbar_conflict_stalls[c], &count_sum);
+            rate_sum = (double)count_sum / time_delta;
+            rate_avg = rate_sum / (double)(_subnets*_routers);
+            os << "Crossbar conflict stall rate = " << rate_avg << endl;
+        }
     
     }
 }
@@ -2097,6 +2647,7 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_plat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallTail(os, _overall_tail_plat[c], _total_sims);
 
         os << "Network latency average = " << _overall_avg_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2104,6 +2655,7 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallTail(os, _overall_tail_nlat[c], _total_sims);
 
         os << "Flit latency average = " << _overall_avg_flat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2111,6 +2663,7 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_flat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        _DisplayOverallTail(os, _overall_tail_flat[c], _total_sims);
 
         os << "Fragmentation average = " << _overall_avg_frag[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2156,18 +2709,18 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
         os << "Hops average = " << _overall_hop_stats[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
     
-#ifdef TRACK_STALLS
-        os << "Buffer busy stall rate = " << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Buffer conflict stall rate = " << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Buffer full stall rate = " << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Buffer reserved stall rate = " << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl
-           << "Crossbar conflict stall rate = " << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims
-           << " (" << _total_sims << " samples)" << endl;
-#endif
+        if(_track_stalls) {
+            os << "Buffer busy stall rate = " << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Buffer conflict stall rate = " << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Buffer full stall rate = " << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Buffer reserved stall rate = " << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl
+               << "Crossbar conflict stall rate = " << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+        }
     
     }
   
@@ -2207,20 +2760,47 @@ string TrafficManager::_OverallStatsCSV(int c) const
        << ',' << _overall_avg_accepted[c] / _overall_avg_accepted_packets[c]
        << ',' << _overall_hop_stats[c] / (double)_total_sims;
 
-#ifdef TRACK_STALLS
-    os << ',' << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
-       << ',' << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims;
-#endif
+    if(_track_stalls) {
+        os << ',' << (double)_overall_buffer_busy_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_buffer_conflict_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_buffer_full_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_buffer_reserved_stalls[c] / (double)_total_sims
+           << ',' << (double)_overall_crossbar_conflict_stalls[c] / (double)_total_sims;
+    }
+
+    return os.str();
+}
 
+string TrafficManager::_OverallStatsCSVHeader() const
+{
+    ostringstream os;
+    os << "traffic,use_read_write,load"
+       << ",min_plat,avg_plat,max_plat"
+       << ",min_nlat,avg_nlat,max_nlat"
+       << ",min_flat,avg_flat,max_flat"
+       << ",min_frag,avg_frag,max_frag"
+       << ",min_sent_packets,avg_sent_packets,max_sent_packets"
+       << ",min_accepted_packets,avg_accepted_packets,max_accepted_packets"
+       << ",min_sent,avg_sent,max_sent"
+       << ",min_accepted,avg_accepted,max_accepted"
+       << ",sent_packet_size,accepted_packet_size,hops";
+    if(_track_stalls) {
+        os << ",buffer_busy_stalls,buffer_conflict_stalls,buffer_full_stalls"
+           << ",buffer_reserved_stalls,crossbar_conflict_stalls";
+    }
     return os.str();
 }
 
 void TrafficManager::DisplayOverallStatsCSV(ostream & os) const {
     for(int c = 0; c < _classes; ++c) {
-        os << "results:" << c << ',' << _OverallStatsCSV() << endl;
+        os << "results:" << c << ',' << _OverallStatsCSV(c) << endl;
+    }
+}
+
+void TrafficManager::WriteOverallStatsCSV(ostream & os) const {
+    os << "class," << _OverallStatsCSVHeader() << endl;
+    for(int c = 0; c < _classes; ++c) {
+        os << c << ',' << _OverallStatsCSV(c) << endl;
     }
 }
 
@@ -29,6 +29,8 @@
 #define _TRAFFICMANAGER_HPP_
 
 #include <list>
+#include <algorithm>
+#include <deque>
 #include <map>
 #include <set>
 #include <cassert>
@@ -39,10 +41,15 @@
 #include "flit.hpp"
 #include "buffer_state.hpp"
 #include "stats.hpp"
+#include "pair_stats.hpp"
 #include "traffic.hpp"
 #include "routefunc.hpp"
 #include "outputset.hpp"
 #include "injection.hpp"
+#include "memory_trace.hpp"
+#include "address_hash.hpp"
+#include "utilization_sampler.hpp"
+#include "profiler.hpp"
 
 //register the requests to a node
 class PacketReplyInfo;
@@ -77,6 +84,11 @@ protected:
   vector<int> _write_request_size;
   vector<int> _write_reply_size;
 
+  // with _flit_width bytes per flit, packet sizes follow from the header
+  // and data bytes they carry
+  int _flit_width;
+  int _header_bytes;
+
   vector<string> _traffic;
 
   vector<int> _class_priority;
@@ -95,10 +107,18 @@ protected:
   // ============ Injection VC states  ============ 
 
   vector<vector<BufferState *> > _buf_states;
-#ifdef TRACK_FLOWS
+
+  // ============ Instrumentation ============ 
+
+  // the routers and buffers read the same options; a checkpoint holds
+  // their counters only for the options that were set
+  bool _track_flows;
+  bool _track_stalls;
+  bool _track_buffers;
+  bool _track_credits;
+
   vector<vector<vector<int> > > _outstanding_credits;
   vector<vector<vector<queue<int> > > > _outstanding_classes;
-#endif
   vector<vector<vector<int> > > _last_vc;
 
   // ============ Routing ============ 
@@ -120,6 +140,9 @@ protected:
 
   bool _hold_switch_for_packet;
 
+  // skip the network phases on cycles where it is quiescent
+  bool _fast_forward;
+
   // ============ physical sub-networks ==========
 
   int _subnets;
@@ -137,6 +160,20 @@ protected:
   vector<list<PacketReplyInfo*> > _repliesPending;
   vector<int> _requestsOutstanding;
 
+  // closed-loop read/write model: sources stop issuing requests while
+  // _mshrs of them are outstanding, and request destinations start at
+  // most _l2_bandwidth requests per cycle, reply _l2_latency cycles later
+  // and hold back the ejection credits of new requests while
+  // _l2_queue_size of them wait for their reply
+  int _mshrs;
+  int _l2_latency;
+  int _l2_bandwidth;
+  int _l2_queue_size;
+  vector<int> _l2_slot_time;
+  vector<int> _l2_slot_used;
+  vector<vector<deque<int> > > _held_credits;
+  int _held_flits;
+
   // ============ Statistics ============
 
   vector<Stats *> _plat_stats;     
@@ -154,14 +191,18 @@ protected:
   vector<double> _overall_avg_flat;  
   vector<double> _overall_max_flat;  
 
+  // sums over simulations of the latency percentiles
+  vector<vector<double> > _overall_tail_plat;
+  vector<vector<double> > _overall_tail_nlat;
+  vector<vector<double> > _overall_tail_flat;
+
   vector<Stats *> _frag_stats;
   vector<double> _overall_min_frag;
   vector<double> _overall_avg_frag;
   vector<double> _overall_max_frag;
 
-  vector<vector<Stats *> > _pair_plat;
-  vector<vector<Stats *> > _pair_nlat;
-  vector<vector<Stats *> > _pair_flat;
+  // per class, with pair_stats
+  vector<PairStats> _pair_lat;
 
   vector<Stats *> _hop_stats;
   vector<double> _overall_hop_stats;
@@ -183,7 +224,6 @@ protected:
   vector<double> _overall_avg_accepted;
   vector<double> _overall_max_accepted;
 
-#ifdef TRACK_STALLS
   vector<vector<int> > _buffer_busy_stalls;
   vector<vector<int> > _buffer_conflict_stalls;
   vector<vector<int> > _buffer_full_stalls;
@@ -194,7 +234,6 @@ protected:
   vector<double> _overall_buffer_full_stalls;
   vector<double> _overall_buffer_reserved_stalls;
   vector<double> _overall_crossbar_conflict_stalls;
-#endif
 
   vector<int> _slowest_packet;
   vector<int> _slowest_flit;
@@ -238,10 +277,37 @@ protected:
 
   bool _print_csv_results;
 
+  // warm-state snapshot written when the first simulation has warmed up,
+  // and snapshot to resume from instead of warming up
+  string _checkpoint_out;
+  string _checkpoint_in;
+
+  // memory trace replayed by class _trace_class in place of its injection
+  // process, with requests sent from the SM to the L2 slice of the address
+  MemoryTrace * _trace;
+  AddressHash * _trace_hash;
+  int _trace_class;
+  int _nodes_sm;
+
+  // L2 slices inject class _mcast_class as multicasts to aligned groups of
+  // _mcast_group SMs; copies of a multicast flit share its id, and
+  // _mcast_copies counts the copies of each one still in the network
+  int _mcast_class;
+  int _mcast_group;
+  int _nodes_l2slice;
+  bool _mcast_unicast;
+  map<int, int> _mcast_copies;
+  map<pair<int, int>, Flit *> _mcast_heads;
+
   //flits to watch
   ostream * _stats_out;
 
-#ifdef TRACK_FLOWS
+  // link and buffer utilization time series, if util_out is set
+  UtilizationSampler * _util_sampler;
+
+  // wall time per phase of _Step, if profile is set
+  Profiler * _profiler;
+
   vector<vector<int> > _injected_flits;
   vector<vector<int> > _ejected_flits;
   ostream * _injected_flits_out;
@@ -251,13 +317,10 @@ protected:
   ostream * _outstanding_credits_out;
   ostream * _ejected_flits_out;
   ostream * _active_packets_out;
-#endif
 
-#ifdef TRACK_CREDITS
   ostream * _used_credits_out;
   ostream * _free_credits_out;
   ostream * _max_credits_out;
-#endif
 
   // ============ Internal methods ============ 
 protected:
@@ -265,12 +328,21 @@ protected:
   virtual void _RetireFlit( Flit *f, int dest );
 
   void _Inject();
+  void _DisplayProfile( ) const;
+  void _InjectTrace( int source, int cl );
   void _Step( );
 
   bool _PacketsOutstanding( ) const;
   
   virtual int  _IssuePacket( int source, int cl );
-  void _GeneratePacket( int source, int size, int cl, int time );
+  void _GeneratePacket( int source, int stype, int cl, int time,
+                        int dest = -1, int flits = -1 );
+  void _GenerateMulticast( int source, int cl, int time );
+  inline int _BytesToFlits( int bytes ) const {
+    return max( 1, ( bytes + _flit_width - 1 ) / _flit_width );
+  }
+  int _L2ReplyTime( int dest, int arrival );
+  Credit * _ReleaseCredits( int node, int subnet );
 
   virtual void _ClearStats( );
 
@@ -278,6 +350,11 @@ protected:
 
   virtual bool _SingleSim( );
 
+  void _SaveCheckpoint( int total_phases, vector<double> const & prev_latency,
+                        vector<double> const & prev_accepted ) const;
+  void _LoadCheckpoint( int & total_phases, vector<double> & prev_latency,
+                        vector<double> & prev_accepted );
+
   void _DisplayRemaining( ostream & os = cout ) const;
   
   void _LoadWatchList(const string & filename);
@@ -285,6 +362,7 @@ protected:
   virtual void _UpdateOverallStats();
 
   virtual string _OverallStatsCSV(int c = 0) const;
+  virtual string _OverallStatsCSVHeader() const;
 
   int _GetNextPacketSize(int cl) const;
   double _GetAveragePacketSize(int cl) const;
@@ -304,6 +382,8 @@ public:
   virtual void DisplayStats( ostream & os = cout ) const ;
   virtual void DisplayOverallStats( ostream & os = cout ) const ;
   virtual void DisplayOverallStatsCSV( ostream & os = cout ) const ;
+  // plain CSV: a line of column names, then one row per class
+  void WriteOverallStatsCSV( ostream & os ) const ;
 
   inline int getTime() { return _time;}
   Stats * getStats(const string & name) { return _stats[name]; }
@@ -0,0 +1,111 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "booksim.hpp"
+#include <sstream>
+#include <cstdio>
+
+#include "utilization_sampler.hpp"
+#include "network.hpp"
+#include "flitchannel.hpp"
+#include "router.hpp"
+
+UtilizationSampler::UtilizationSampler( vector<Network *> const & net,
+					string const & filename, int period )
+  : _period( period ), _last_time( 0 ), _out( filename )
+{
+  ostringstream header;
+  header << "cycle";
+  for ( size_t s = 0; s < net.size( ); ++s ) {
+    string const prefix = ( net.size( ) > 1 ) ?
+      ( "s" + to_string( s ) + "." ) : string( );
+    vector<FlitChannel *> const & channels = net[s]->GetChannels( );
+    for ( size_t c = 0; c < channels.size( ); ++c ) {
+      FlitChannel const * const ch = channels[c];
+      if ( !ch->GetSource( ) || !ch->GetSink( ) ) {
+	continue;
+      }
+      ostringstream link;
+      link << prefix << "r" << ch->GetSource( )->GetID( ) << "." << ch->GetSourcePort( )
+	   << "-r" << ch->GetSink( )->GetID( ) << "." << ch->GetSinkPort( );
+      header << ",util_" << link.str( ) << ",cred_" << link.str( );
+      _channels.push_back( ch );
+      _sent.push_back( _Sent( ch ) );
+    }
+    vector<Router *> const & routers = net[s]->GetRouters( );
+    for ( size_t r = 0; r < routers.size( ); ++r ) {
+      header << ",occ_" << prefix << "r" << routers[r]->GetID( );
+      _routers.push_back( routers[r] );
+    }
+  }
+  header << "\n";
+  _out.Write( header.str( ) );
+}
+
+long long UtilizationSampler::_Sent( FlitChannel const * c )
+{
+  vector<int> const & active = c->GetActivity( );
+  long long sent = 0;
+  for ( size_t i = 0; i < active.size( ); ++i ) {
+    sent += active[i];
+  }
+  return sent;
+}
+
+void UtilizationSampler::Sample( int time )
+{
+  // a new simulation restarts the clock
+  int const elapsed = ( time > _last_time ) ? ( time - _last_time ) : time;
+  _last_time = time;
+  if ( elapsed <= 0 ) {
+    return;
+  }
+
+  string row = to_string( time );
+  char util[32];
+  for ( size_t c = 0; c < _channels.size( ); ++c ) {
+    FlitChannel const * const ch = _channels[c];
+    long long const sent = _Sent( ch );
+    snprintf( util, sizeof( util ), ",%.4g,",
+	      (double)( sent - _sent[c] ) / ( (double)elapsed * ch->GetBandwidth( ) ) );
+    _sent[c] = sent;
+    row += util;
+    row += to_string( ch->GetSource( )->GetUsedCredit( ch->GetSourcePort( ) ) );
+  }
+  for ( size_t r = 0; r < _routers.size( ); ++r ) {
+    Router const * const rtr = _routers[r];
+    int occupancy = 0;
+    for ( int i = 0; i < rtr->NumInputs( ); ++i ) {
+      occupancy += rtr->GetBufferOccupancy( i );
+    }
+    row += ",";
+    row += to_string( occupancy );
+  }
+  row += "\n";
+  _out.Write( row );
+}
@@ -0,0 +1,81 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*utilization_sampler.hpp
+ *
+ *Time series of network utilization, one CSV row every period cycles.
+ *For each channel between two routers the row holds the fraction of its
+ *bandwidth used since the previous row and the credits in use at its
+ *source port; for each router it holds the flits in its input buffers.
+ *The header names the columns util_<link>, cred_<link> and occ_r<router>,
+ *where a link r3.1-r7.0 runs from port 1 of router 3 to port 0 of router 7,
+ *with an s<subnet>. prefix if there are several subnets.
+ *
+ */
+
+#ifndef _UTILIZATION_SAMPLER_HPP_
+#define _UTILIZATION_SAMPLER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "async_writer.hpp"
+
+class Network;
+class FlitChannel;
+class Router;
+
+using namespace std;
+
+class UtilizationSampler {
+
+  int _period;
+
+  vector<FlitChannel const *> _channels;
+  vector<Router const *> _routers;
+
+  // flits sent on each channel up to the previous row
+  vector<long long> _sent;
+  int _last_time;
+
+  AsyncWriter _out;
+
+  static long long _Sent( FlitChannel const * c );
+
+public:
+
+  UtilizationSampler( vector<Network *> const & net, string const & filename,
+		      int period );
+
+  inline int Period( ) const { return _period; }
+
+  void Sample( int time );
+
+};
+
+#endif
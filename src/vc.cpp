@@ -39,6 +39,7 @@
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "vc.hpp"
+#include "checkpoint.hpp"
 
 const char * const VC::VCSTATE[] = {"idle",
 				    "routing",
@@ -124,6 +125,12 @@ Flit *VC::RemoveFlit( )
 
 
 
+void VC::RequeueFlits( vector<Flit *> const & flits )
+{
+  _buffer.insert(_buffer.begin(), flits.begin(), flits.end());
+  UpdatePriority();
+}
+
 void VC::SetState( eVCState s )
 {
   Flit * f = FrontFlit();
@@ -192,6 +199,50 @@ void VC::Route( tRoutingFunction rf, const Router* router, const Flit* f, int in
   _out_vc = -1;
 }
 
+// ==== Checkpointing ====
+
+void VC::Save( CheckpointWriter & w ) const
+{
+  w.Write( _buffer );
+  w.Write( (int)_state );
+  // a lookahead route set lives in the flit at the front of the buffer
+  bool const front_route = _lookahead_routing && !_buffer.empty( ) &&
+    ( _route_set == &_buffer.front( )->la_route_set );
+  w.Write( front_route );
+  if ( !_lookahead_routing ) {
+    w.Write( *_route_set );
+  }
+  w.Write( _out_port );
+  w.Write( _out_vc );
+  w.Write( _pri );
+  w.Write( _watched );
+  w.Write( _expected_pid );
+  w.Write( _last_id );
+  w.Write( _last_pid );
+}
+
+void VC::Load( CheckpointReader & r )
+{
+  int state;
+  bool front_route;
+  r.Read( _buffer );
+  r.Read( state );
+  _state = (eVCState)state;
+  r.Read( front_route );
+  if ( _lookahead_routing ) {
+    _route_set = front_route ? &_buffer.front( )->la_route_set : NULL;
+  } else {
+    r.Read( *_route_set );
+  }
+  r.Read( _out_port );
+  r.Read( _out_vc );
+  r.Read( _pri );
+  r.Read( _watched );
+  r.Read( _expected_pid );
+  r.Read( _last_id );
+  r.Read( _last_pid );
+}
+
 // ==== Debug functions ====
 
 void VC::SetWatch( bool watch )
@@ -35,6 +35,9 @@
 #include "routefunc.hpp"
 #include "config_utils.hpp"
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class VC : public Module {
 public:
   enum eVCState { state_min = 0, idle = state_min, routing, vc_alloc, active, 
@@ -83,6 +86,9 @@ public:
   }
   
   Flit *RemoveFlit( );
+
+  // put flits that already left back in front of the buffer
+  void RequeueFlits( vector<Flit *> const & flits );
   
   
   inline bool Empty( ) const
@@ -127,6 +133,11 @@ public:
     return (int)_buffer.size();
   }
 
+  // ==== Checkpointing ====
+
+  void Save( CheckpointWriter & w ) const;
+  void Load( CheckpointReader & r );
+
   // ==== Debug functions ====
 
   void SetWatch( bool watch = true );
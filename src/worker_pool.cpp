@@ -0,0 +1,96 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*worker_pool.cpp
+ *
+ *Workers spin briefly before yielding while waiting for the next task, as
+ *tasks are issued several times per simulated cycle
+ *
+ */
+
+#include <cassert>
+
+#include "worker_pool.hpp"
+
+static inline void _Backoff(int & spins)
+{
+  if(++spins > 1024) {
+    this_thread::yield();
+  }
+}
+
+WorkerPool::WorkerPool(int workers)
+  : _workers(workers), _task(NULL), _arg(NULL), _generation(0), _pending(0),
+    _stop(false)
+{
+  assert(workers > 0);
+  for(int w = 1; w < _workers; ++w) {
+    _threads.push_back(thread(&WorkerPool::_Work, this, w));
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  _stop.store(true, memory_order_release);
+  _generation.fetch_add(1, memory_order_acq_rel);
+  for(size_t t = 0; t < _threads.size(); ++t) {
+    _threads[t].join();
+  }
+}
+
+void WorkerPool::Run(Task task, void * arg)
+{
+  _task = task;
+  _arg = arg;
+  _pending.store(_workers - 1, memory_order_relaxed);
+  _generation.fetch_add(1, memory_order_acq_rel);
+
+  task(arg, 0);
+
+  int spins = 0;
+  while(_pending.load(memory_order_acquire) > 0) {
+    _Backoff(spins);
+  }
+}
+
+void WorkerPool::_Work(int worker)
+{
+  unsigned int seen = 0;
+  while(true) {
+    int spins = 0;
+    unsigned int gen;
+    while((gen = _generation.load(memory_order_acquire)) == seen) {
+      _Backoff(spins);
+    }
+    seen = gen;
+    if(_stop.load(memory_order_acquire)) {
+      return;
+    }
+    _task(_arg, worker);
+    _pending.fetch_sub(1, memory_order_acq_rel);
+  }
+}
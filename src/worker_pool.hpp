@@ -0,0 +1,75 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*worker_pool.hpp
+ *
+ *A fixed set of worker threads that repeatedly execute the same task in
+ *lock step with the calling thread; used to shard the per-cycle phases of a
+ *network across cores
+ *
+ */
+
+#ifndef _WORKER_POOL_HPP_
+#define _WORKER_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+class WorkerPool {
+public:
+  typedef void (*Task)(void * arg, int worker);
+
+private:
+  int _workers;
+  vector<thread> _threads;
+
+  Task _task;
+  void * _arg;
+
+  // bumped once per Run() to release the workers
+  atomic<unsigned int> _generation;
+  // workers that have not yet finished the current task
+  atomic<int> _pending;
+  atomic<bool> _stop;
+
+  void _Work(int worker);
+
+public:
+  // the calling thread acts as worker 0, so workers - 1 threads are spawned
+  WorkerPool(int workers);
+  ~WorkerPool();
+
+  inline int NumWorkers() const {return _workers;}
+
+  // execute task(arg, w) for every worker w and return once all are done
+  void Run(Task task, void * arg);
+};
+
+#endif